@@ -0,0 +1,89 @@
+// Compares AlphaBlend with SDL_BlitSurface for one frame worth of text and
+// a translucent panel at 640x480. Build with `make bench`, then run
+// output/blend_bench [frames]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <SDL/SDL.h>
+
+#include "AlphaBlend.h"
+
+namespace {
+
+const int SCREEN_W = 640;
+const int SCREEN_H = 480;
+const int TEXT_ROWS = 12;
+
+// Anti-aliased text is mostly transparent with opaque strokes and a few
+// partially covered edge pixels
+SDL_Surface* makeText(int w, int h) {
+    SDL_Surface* surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32,
+                                                0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    std::srand(1);
+    for (int y = 0; y < h; y++) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < w; x++) {
+            int r = std::rand() % 10;
+            Uint32 alpha = r < 6 ? 0 : r < 9 ? 255 : std::rand() & 0xff;
+            row[x] = (alpha << 24) | 0x00ffffff;
+        }
+    }
+    return surface;
+}
+
+template <typename F>
+double measure(int frames, F draw) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++) {
+        draw();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+        / frames;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+
+    SDL_Surface* screen = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32,
+                                               0x00ff0000, 0x0000ff00, 0x000000ff, 0);
+    SDL_FillRect(screen, nullptr, 0x00406080);
+
+    SDL_Surface* text = makeText(SCREEN_W / 2, 24);
+    SDL_SetAlpha(text, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+    SDL_Surface* premultiplied = SDL_ConvertSurface(text, text->format, SDL_SWSURFACE);
+    AlphaBlend::premultiply(premultiplied);
+
+    SDL_Surface* panel = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, 96, 32, 0, 0, 0, 0);
+    SDL_FillRect(panel, nullptr, 0);
+    SDL_SetAlpha(panel, SDL_SRCALPHA, 127);
+
+    double sdl = measure(frames, [&] {
+        SDL_Rect panelRect = {0, SCREEN_H / 2 - 48, 0, 0};
+        SDL_BlitSurface(panel, nullptr, screen, &panelRect);
+        for (int i = 0; i < TEXT_ROWS; i++) {
+            SDL_Rect rect = {20, static_cast<Sint16>(20 + i * 36), 0, 0};
+            SDL_BlitSurface(text, nullptr, screen, &rect);
+        }
+    });
+
+    double blend = measure(frames, [&] {
+        SDL_Rect panelRect = {0, SCREEN_H / 2 - 48, SCREEN_W, 96};
+        AlphaBlend::fillRect(screen, &panelRect, {0, 0, 0}, 127);
+        for (int i = 0; i < TEXT_ROWS; i++) {
+            SDL_Rect rect = {20, static_cast<Sint16>(20 + i * 36), 0, 0};
+            AlphaBlend::blit(premultiplied, nullptr, screen, &rect);
+        }
+    });
+
+    std::printf("SDL_BlitSurface %8.3f ms/frame\n", sdl);
+    std::printf("AlphaBlend      %8.3f ms/frame (%.1fx)\n", blend, sdl / blend);
+
+    SDL_FreeSurface(panel);
+    SDL_FreeSurface(premultiplied);
+    SDL_FreeSurface(text);
+    SDL_FreeSurface(screen);
+    return 0;
+}
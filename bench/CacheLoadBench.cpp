@@ -0,0 +1,174 @@
+// Compares the JSON cache loader, a rapidjson SAX handler, with the
+// rapidjson::Document loader it replaced: time and peak memory per load of
+// a generated cache. Build with `make bench`, then run
+// output/cache_bench [items ...]. Without counts it loads 10k, 50k and
+// 100k item caches
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <rapidjson/document.h>
+#include <rapidjson/filereadstream.h>
+
+#include "MenuCache.h"
+
+namespace {
+
+const int ITEMS_PER_DIRECTORY = 200;
+
+// Same layout as MenuCache::exportToJSON, consoles of a few hundred roms
+bool writeCache(const std::string& path, int count) {
+    FILE* fp = std::fopen(path.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+    const char* folders[] = {"snes", "megadrive", "gba", "psx", "nes", "mame"};
+    int directories = (count + ITEMS_PER_DIRECTORY - 1) / ITEMS_PER_DIRECTORY;
+
+    std::fprintf(fp, "{\n    \"directories\": [\n");
+    for (int d = 0; d < directories; d++) {
+        int entries = std::min(ITEMS_PER_DIRECTORY, count - d * ITEMS_PER_DIRECTORY);
+        std::fprintf(fp, "        {\n            \"section\": \"consoles.ini\",\n"
+                         "            \"folder\": \"%s\",\n"
+                         "            \"path\": \"/userdata/roms/%s/set%04d\",\n"
+                         "            \"mtime\": %d,\n            \"entries\": %d\n        }%s\n",
+                     folders[d % 6], folders[d % 6], d, 1700000000 + d, entries,
+                     d + 1 < directories ? "," : "");
+    }
+    std::fprintf(fp, "    ],\n    \"items\": [\n");
+    for (int i = 0; i < count; i++) {
+        int d = i / ITEMS_PER_DIRECTORY;
+        std::fprintf(fp, "        {\n            \"section\": \"consoles.ini\",\n"
+                         "            \"folder\": \"%s\",\n"
+                         "            \"rom\": \"Game %06d (Europe).zip\",\n"
+                         "            \"path\": \"/userdata/roms/%s/set%04d/Game %06d (Europe).zip\",\n"
+                         "            \"core\": \"%s_libretro\"\n        }%s\n",
+                     folders[d % 6], i, folders[d % 6], d, i, folders[d % 6],
+                     i + 1 < count ? "," : "");
+    }
+    std::fprintf(fp, "    ]\n}\n");
+    return std::fclose(fp) == 0;
+}
+
+// The loader before the SAX handler: the whole file is parsed into a
+// Document, then copied out of it
+bool loadDocument(const std::string& filePath,
+                  std::vector<CachedMenuItem>& data,
+                  std::vector<CachedDirectory>& directories) {
+    FILE* fp = std::fopen(filePath.c_str(), "r");
+    if (!fp) return false;
+    char readBuffer[65536];
+    rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+    rapidjson::Document doc;
+    doc.ParseStream(is);
+    std::fclose(fp);
+
+    if (!doc.IsObject() || !doc.HasMember("items") || !doc["items"].IsArray()) {
+        return false;
+    }
+    if (doc.HasMember("directories") && doc["directories"].IsArray()) {
+        for (auto& v : doc["directories"].GetArray()) {
+            CachedDirectory dir;
+            dir.section = v["section"].GetString();
+            dir.folder  = v["folder"].GetString();
+            dir.path    = v["path"].GetString();
+            dir.mtime   = v["mtime"].GetInt64();
+            dir.entries = v["entries"].GetUint64();
+            directories.push_back(dir);
+        }
+    }
+
+    const rapidjson::Value& items = doc["items"];
+    data.reserve(items.Size());
+    for (auto& v : items.GetArray()) {
+        CachedMenuItem item;
+        item.section = v["section"].GetString();
+        item.folder  = v["folder"].GetString();
+        item.rom     = v["rom"].GetString();
+        item.path    = v["path"].GetString();
+        item.core    = v["core"].GetString();
+        data.push_back(item);
+    }
+    return true;
+}
+
+long residentKiB() {
+    long pages = 0, resident = 0;
+    if (FILE* fp = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(fp, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(fp);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// Each load runs in its own process, so the peak resident size is that of
+// this loader alone and the allocator keeps nothing from the previous one
+template <typename F>
+void measure(const char* name, F load) {
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        return;
+    }
+    if (pid > 0) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return;
+    }
+
+    long before = residentKiB();
+    std::vector<CachedMenuItem> data;
+    std::vector<CachedDirectory> directories;
+    auto start = std::chrono::steady_clock::now();
+    bool loaded = load(data, directories);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("  %-10s %9.1f ms %8ld KiB peak %8zu items%s\n", name, ms,
+                usage.ru_maxrss - before, data.size(), loaded ? "" : " (failed)");
+    std::fflush(stdout);
+    _exit(0);
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> counts;
+    for (int i = 1; i < argc; i++) {
+        counts.push_back(std::max(1, std::atoi(argv[i])));
+    }
+    if (counts.empty()) {
+        counts = {10000, 50000, 100000};
+    }
+
+    for (int count : counts) {
+        std::string path = "/tmp/cache_bench_" + std::to_string(count) + ".json";
+        if (!writeCache(path, count)) {
+            std::perror(path.c_str());
+            return 1;
+        }
+        std::printf("%d items\n", count);
+
+        measure("Document", [&path](std::vector<CachedMenuItem>& data,
+                                    std::vector<CachedDirectory>& directories) {
+            return loadDocument(path, data, directories);
+        });
+        measure("SAX", [&path](std::vector<CachedMenuItem>& data,
+                               std::vector<CachedDirectory>& directories) {
+            MenuCache cache;
+            return cache.importFromJSON(path, data, directories);
+        });
+
+        std::remove(path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Compares IniFile with boost::property_tree::read_ini on the startup ini
+// files: time and heap allocations per parse. Build with `make bench`, then
+// run output/ini_bench [iterations] [file.ini ...]. Without files it reads
+// the ones in resources/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <boost/property_tree/ini_parser.hpp>
+
+#include "IniFile.h"
+
+namespace {
+
+std::size_t allocations = 0;
+
+template <typename F>
+void measure(const char* name, int iterations, F parse) {
+    std::size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    std::size_t values = 0;
+    for (int i = 0; i < iterations; i++) {
+        values = parse();
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()
+        / iterations;
+    std::printf("  %-10s %9.1f us %8zu allocs %6zu values\n", name, us,
+                (allocations - before) / iterations, values);
+}
+
+}
+
+// Not inlined, so the compiler does not pair malloc with the deletes below
+__attribute__((noinline)) void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+
+    std::vector<std::string> files(argv + std::min(argc, 2), argv + argc);
+    if (files.empty()) {
+        files = {"resources/config.ini", "resources/i18n.ini",
+                 "resources/section_groups/arcades.ini", "resources/section_groups/computers.ini",
+                 "resources/section_groups/handhelds.ini"};
+    }
+
+    for (const std::string& file : files) {
+        std::printf("%s\n", file.c_str());
+
+        measure("read_ini", iterations, [&file] {
+            boost::property_tree::ptree pt;
+            boost::property_tree::ini_parser::read_ini(file, pt);
+            std::size_t values = 0;
+            for (const auto& section : pt) {
+                // Sections are never empty, an empty child is a top level key
+                values += section.second.empty() ? 1 : section.second.size();
+            }
+            return values;
+        });
+
+        measure("IniFile", iterations, [&file] {
+            IniFile ini(file);
+            std::size_t values = ini.getTopLevel().end - ini.getTopLevel().begin;
+            for (const auto& section : ini.getSections()) {
+                values += section.end - section.begin;
+            }
+            return values;
+        });
+    }
+    return 0;
+}
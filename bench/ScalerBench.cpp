@@ -0,0 +1,82 @@
+// Compares ImageScaler with SDL_gfx zoomSurface on thumbnail sized targets.
+// Build with `make bench`, then run output/scaler_bench [iterations]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <SDL/SDL.h>
+#include <SDL/SDL_rotozoom.h>
+
+#include "ImageScaler.h"
+
+namespace {
+
+const int TARGET_W = 432;
+const int TARGET_H = 322;
+
+SDL_Surface* makeSource(int w, int h) {
+    SDL_Surface* surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32,
+                                                0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    std::srand(1);
+    for (int y = 0; y < h; y++) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = 0; x < w; x++) {
+            row[x] = 0xff000000 | (std::rand() & 0x00ffffff);
+        }
+    }
+    return surface;
+}
+
+template <typename F>
+double measure(int iterations, F scale) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        SDL_Surface* result = scale();
+        SDL_FreeSurface(result);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+        / iterations;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+
+    SDL_PixelFormat argb = ImageScaler::getDefaultFormat();
+    SDL_PixelFormat rgb565 = ImageScaler::makeFormat(16, 0xf800, 0x07e0, 0x001f, 0);
+
+    const int sizes[][2] = {{640, 480}, {1280, 960}, {256, 224}};
+    std::printf("%-12s %12s %12s %12s %12s\n", "source", "zoomSurface", "zoom+565", "scaler", "scaler 565");
+
+    for (const auto& size : sizes) {
+        SDL_Surface* source = makeSource(size[0], size[1]);
+        double factor = std::min(static_cast<double>(TARGET_W) / size[0],
+                                 static_cast<double>(TARGET_H) / size[1]);
+
+        // zoomSurface needs a conversion afterwards to reach a 16 bpp screen
+        double zoom = measure(iterations, [&] {
+            return zoomSurface(source, factor, factor, SMOOTHING_ON);
+        });
+        double zoom565 = measure(iterations, [&] {
+            SDL_Surface* zoomed = zoomSurface(source, factor, factor, SMOOTHING_ON);
+            SDL_Surface* converted = SDL_ConvertSurface(zoomed, &rgb565, SDL_SWSURFACE);
+            SDL_FreeSurface(zoomed);
+            return converted;
+        });
+        double scaler = measure(iterations, [&] {
+            return ImageScaler::fit(source, TARGET_W, TARGET_H, argb);
+        });
+        double scaler565 = measure(iterations, [&] {
+            return ImageScaler::fit(source, TARGET_W, TARGET_H, rgb565);
+        });
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "%dx%d", size[0], size[1]);
+        std::printf("%-12s %9.2f ms %9.2f ms %9.2f ms %9.2f ms\n", name, zoom, zoom565, scaler, scaler565);
+
+        SDL_FreeSurface(source);
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <SDL/SDL.h>
+
+/**
+ * Alpha blending for text, overlays and translucent panels. Sources are
+ * 32 bpp surfaces with premultiplied alpha, so a blend is one multiply per
+ * channel: dst = src + dst * (255 - alpha) / 255. Blending into a 32 bpp
+ * screen uses NEON or SSE2 when the target has them, other formats take
+ * the scalar path.
+ */
+class AlphaBlend {
+public:
+    // Premultiply the colors of a 32 bpp surface by its alpha channel, in
+    // place. Only the given rectangle when there is one
+    static void premultiply(SDL_Surface* surface, const SDL_Rect* rect = nullptr);
+
+    // Blend a premultiplied surface onto dst. Clipping and the final dstRect
+    // follow SDL_BlitSurface
+    static void blit(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect);
+
+    // Blend a translucent color over a rectangle of dst, the whole clip
+    // rectangle when rect is nullptr
+    static void fillRect(SDL_Surface* dst, const SDL_Rect* rect, SDL_Color color, Uint8 alpha);
+};
@@ -21,10 +21,12 @@
 #include "FileManager.h"
 #include "ControlMapping.h"
 #include "MenuCache.h"
+#include "RomScanner.h"
 #include "Menu.h"
 #include "HelperUtils.h"
 #include "Settings.h"
 #include "I18n.h"
+#include "SystemRegistry.h"
 
 namespace pt = boost::property_tree;
 
@@ -43,6 +45,9 @@ private:
     Configuration cfg;
     Theme theme;
     I18n i18n;
+
+    // Section groups and their consoles, shared with the settings
+    SystemRegistry systems;
     
     AppSettings appSettings;
     SystemSettings systemSettings;
@@ -67,14 +72,29 @@ private:
     int currentRomSettingsIndex = 0;
     int currentSettingsValue = 0;
 
-    bool isButtonHeld;
+    bool isButtonHeld = false;
     SDL_Event lastHeldEvent;
     unsigned int repeatStartTime;
     unsigned int repeatInterval;
 
+    // Input is polled at this interval while the main loop sleeps, when no
+    // timer is available to wake it
+    static const Uint32 INPUT_POLL_INTERVAL = 10;
+
+    // User event code of the timer that ends waitEvent at its deadline
+    static const int DEADLINE_EVENT = 1;
+    static Uint32 pushDeadlineEvent(Uint32 interval, void* param);
+
+    // Wait for the next event until the deadline, false on timeout
+    bool waitEvent(SDL_Event& event, Uint32 deadline);
+
     void loadCache(bool force = false);
 
-    std::vector<CachedMenuItem> populateCache();
+    std::string getCacheFilePath();
+
+    std::vector<CachedMenuItem> populateCache(const Catalog& previous,
+                                              std::vector<CachedDirectory>& directories,
+                                              bool& changed);
 
     void populateMenu(Menu& menu);
 
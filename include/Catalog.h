@@ -0,0 +1,122 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct CachedMenuItem {
+    std::string section;
+    std::string folder;
+    std::string rom;
+    std::string path;
+    std::string core;
+};
+
+// Rom directory stamp stored alongside the cached items. Items produced by
+// a directory are stored contiguously, in the same order as the directories
+struct CachedDirectory {
+    std::string section;
+    std::string folder;
+    std::string path;
+    std::int64_t mtime;
+    std::size_t entries;
+};
+
+/**
+ * Binary catalog file layout, all values in host byte order:
+ *
+ *   CatalogHeader
+ *   CatalogDirectory[directoryCount]
+ *   CatalogItem[itemCount]
+ *   string table (NUL terminated, deduplicated strings)
+ *
+ * Records refer to strings by their offset in the string table, so the
+ * file can be mapped and read in place without any parsing.
+ */
+struct CatalogHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t directoryCount;
+    std::uint32_t itemCount;
+    std::uint32_t stringTableSize;
+    std::uint32_t directoriesOffset;
+    std::uint32_t itemsOffset;
+    std::uint32_t stringsOffset;
+};
+
+struct CatalogDirectory {
+    std::uint32_t section;
+    std::uint32_t folder;
+    std::uint32_t path;
+    std::uint32_t entries;
+    std::int64_t mtime;
+};
+
+struct CatalogItem {
+    std::uint32_t section;
+    std::uint32_t folder;
+    std::uint32_t rom;
+    std::uint32_t path;
+    std::uint32_t core;
+};
+
+class Catalog {
+private:
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+
+    const CatalogHeader* header = nullptr;
+    const CatalogDirectory* directories = nullptr;
+    const CatalogItem* items = nullptr;
+    const char* strings = nullptr;
+
+    // Out of range lookups, or any lookup on a closed catalog, read empty
+    // records and strings rather than the unmapped arrays
+    static const CatalogItem EMPTY_ITEM;
+    static const CatalogDirectory EMPTY_DIRECTORY;
+
+    const char* getString(std::uint32_t offset) const {
+        return header && offset < header->stringTableSize ? strings + offset : "";
+    }
+    const CatalogItem& getRecord(std::size_t index) const {
+        return index < size() ? items[index] : EMPTY_ITEM;
+    }
+
+    void swap(Catalog& other) noexcept;
+
+public:
+    static const char MAGIC[4];
+    static const std::uint32_t VERSION;
+
+    Catalog() = default;
+    ~Catalog();
+
+    Catalog(const Catalog&) = delete;
+    Catalog& operator=(const Catalog&) = delete;
+
+    // Map a catalog file, returns false if it is missing or not valid. The
+    // previous mapping is only replaced on success, so readers of a failed
+    // open keep the catalog they had
+    bool open(const std::string& filePath);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    std::size_t size() const { return header ? header->itemCount : 0; }
+
+    const char* getSection(std::size_t index) const { return getString(getRecord(index).section); }
+    const char* getFolder(std::size_t index) const { return getString(getRecord(index).folder); }
+    const char* getRom(std::size_t index) const { return getString(getRecord(index).rom); }
+    const char* getPath(std::size_t index) const { return getString(getRecord(index).path); }
+    const char* getCore(std::size_t index) const { return getString(getRecord(index).core); }
+
+    CachedMenuItem getItem(std::size_t index) const;
+
+    std::size_t getDirectoryCount() const { return header ? header->directoryCount : 0; }
+    CachedDirectory getDirectory(std::size_t index) const;
+
+    // Write a new catalog file. The file is written next to its final
+    // location and renamed over it, so existing mappings stay valid
+    static bool write(const std::string& filePath,
+                      const std::vector<CachedMenuItem>& data,
+                      const std::vector<CachedDirectory>& directories);
+};
@@ -7,16 +7,10 @@
 #include <set>
 #include <vector>
 #include <memory>
+#include <array>
 
 #include "State.h"
 
-struct ConsoleData {
-    std::string name;
-    std::vector<std::string> execs;
-    std::vector<std::string> romExts;
-    std::vector<std::string> romDirs;
-};
-
 struct SettingsMenuItem {
     std::string id;
     std::string type;
@@ -38,6 +32,81 @@ private:
 
     boost::property_tree::ptree mainPt;
 
+public:
+
+    // config.ini keys read by the menu at runtime. Each one has a typed slot
+    // parsed when the file loads and refreshed by set(), so reading it is an
+    // array index. The string ids below stay for ini I/O and settings menus
+    enum class Key : std::size_t {
+        // GLOBAL
+        ALIAS_PATH,
+        HOME_PATH,
+        THEME_PATH,
+        ROMS_PATH,
+        IMAGES_PATH,
+        SCREEN_WIDTH,
+        SCREEN_HEIGHT,
+        SCREEN_DEPTH,
+        GLOBAL_CACHE,
+        GLOBAL_CATALOG,
+        EXPORT_CACHE_JSON,
+        SCAN_THREADS,
+        TEXT_CACHE_KB,
+        THUMBNAIL_CACHE_KB,
+        BACKGROUND_CACHE_KB,
+        THUMBNAIL_DISK_CACHE,
+        THUMBNAIL_DISK_CACHE_MB,
+        THUMBNAIL_PREFETCH_AHEAD,
+        THUMBNAIL_PREFETCH_BEHIND,
+        OVERCLOCK_VALUES,
+        THUMBNAIL_TYPE_VALUES,
+        USB_MODE_VALUES,
+        // APPLICATION
+        VOLUME,
+        BRIGHTNESS,
+        SCREEN_REFRESH,
+        SHOW_FPS,
+        IDLE_REFRESH,
+        OVERCLOCK,
+        THEME,
+        THUMBNAIL_TYPE,
+        USB_MODE,
+        WIFI,
+        ROTATION,
+        LANGUAGE,
+        UPDATE_CACHES,
+        RESTART,
+        QUIT,
+        // SYSTEM
+        CORE_SELECTION,
+        // GAME
+        ROM_OVERCLOCK,
+        ROM_AUTOSTART,
+        CORE_OVERRIDE,
+        COUNT
+    };
+
+private:
+
+    struct Slot {
+        std::string text;
+        int intValue = 0;
+        bool boolValue = false;
+        bool present = false;
+        bool isInt = false;
+        bool isBool = false;
+    };
+
+    static const std::string* const KEY_IDS[];
+    std::array<Slot, static_cast<std::size_t>(Key::COUNT)> slots;
+
+    const Slot& slot(Key key) const {
+        return slots[static_cast<std::size_t>(key)];
+    }
+    void refresh(Key key);
+    static bool findKey(const std::string& id, Key& key);
+    [[noreturn]] static void throwBadKey(Key key, const char* type);
+
 public:
 
     /////////
@@ -59,12 +128,23 @@ public:
     static const std::string SCREEN_HEIGHT;
     static const std::string SCREEN_DEPTH;
     static const std::string GLOBAL_CACHE;
+    static const std::string GLOBAL_CATALOG;
+    static const std::string EXPORT_CACHE_JSON;
+    static const std::string SCAN_THREADS;
+    static const std::string TEXT_CACHE_KB;
+    static const std::string THUMBNAIL_CACHE_KB;
+    static const std::string BACKGROUND_CACHE_KB;
+    static const std::string THUMBNAIL_DISK_CACHE;
+    static const std::string THUMBNAIL_DISK_CACHE_MB;
+    static const std::string THUMBNAIL_PREFETCH_AHEAD;
+    static const std::string THUMBNAIL_PREFETCH_BEHIND;
 
     // CONFIG . SYSTEM section
     static const std::string VOLUME;
     static const std::string BRIGHTNESS;
     static const std::string SCREEN_REFRESH;
     static const std::string SHOW_FPS;
+    static const std::string IDLE_REFRESH;
     static const std::string OVERCLOCK_VALUES;
     static const std::string OVERCLOCK;
     static const std::string THEME;
@@ -149,15 +229,50 @@ public:
                   const std::string& stateFilepath);
 
     void set(const std::string& id, const std::string& value);
+    void set(Key key, const std::string& value);
+
+    static const std::string& getId(Key key) {
+        return *KEY_IDS[static_cast<std::size_t>(key)];
+    }
+
+    const std::string& get(Key key) const {
+        const Slot& s = slot(key);
+        if (!s.present) throwBadKey(key, "string");
+        return s.text;
+    }
+    std::string get(Key key, const std::string& defaultValue) const {
+        const Slot& s = slot(key);
+        return s.present ? s.text : defaultValue;
+    }
+    int getInt(Key key) const {
+        const Slot& s = slot(key);
+        if (!s.isInt) throwBadKey(key, "int");
+        return s.intValue;
+    }
+    int getInt(Key key, int defaultValue) const {
+        const Slot& s = slot(key);
+        return s.isInt ? s.intValue : defaultValue;
+    }
+    bool getBool(Key key) const {
+        const Slot& s = slot(key);
+        if (!s.isBool) throwBadKey(key, "bool");
+        return s.boolValue;
+    }
+    bool getBool(Key key, bool defaultValue) const {
+        const Slot& s = slot(key);
+        return s.isBool ? s.boolValue : defaultValue;
+    }
 
     std::string get(const std::string& id) const;
+    std::string get(const std::string& id, const std::string& defaultValue) const;
     bool getBool(const std::string& id) const;
+    bool getBool(const std::string& id, bool defaultValue) const;
     int getInt(const std::string& id) const;
+    int getInt(const std::string& id, int defaultValue) const;
 
     std::set<std::string> getList(const std::string& id, 
                                   const char delimiter = ',') const;
     std::string getThemePath() const;
-    std::map<std::string, ConsoleData> parseIniFile(const std::string& iniPath);
 
     void saveConfigIni();
 
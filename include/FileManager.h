@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <set>
+#include <cstdint>
 
 #include "Configuration.h"
 
@@ -8,13 +10,18 @@ class FileManager {
 
 private:
     Configuration cfg;
+    std::set<std::string> excludedExtensions;
 
 public:
 
-    FileManager(Configuration& cfg): cfg(cfg) {};
+    FileManager(Configuration& cfg)
+        : cfg(cfg), excludedExtensions(cfg.getList("GLOBAL.excludedExtensions")) {};
 
     std::vector<std::string> getFolders(const std::string& path);
     std::vector<std::string> getFiles(const std::string& folder);
 
+    // Modification time of a directory in nanoseconds, 0 if it can't be read
+    std::int64_t getModificationTime(const std::string& path);
+
 };
 
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <functional>
+#include <SDL/SDL_ttf.h>
+
+/**
+ * Process wide registry of open fonts. Every face is loaded once per
+ * (path, size, hinting, style) and shared by every renderer; fonts are owned
+ * by the registry and stay valid until clear() is called on theme change.
+ */
+class FontRegistry {
+private:
+    struct FontKey {
+        std::string path;
+        int size;
+        int hinting;
+        int style;
+
+        bool operator==(const FontKey& other) const {
+            return size == other.size && hinting == other.hinting
+                && style == other.style && path == other.path;
+        }
+    };
+
+    struct FontKeyHash {
+        std::size_t operator()(const FontKey& key) const {
+            std::size_t h = std::hash<std::string>()(key.path);
+            h ^= std::hash<int>()(key.size) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<int>()((key.hinting << 8) | key.style) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    // Fonts that failed to load are kept as nullptr so they are not retried
+    // on every frame
+    std::unordered_map<FontKey, TTF_Font*, FontKeyHash> fonts;
+
+    FontRegistry() = default;
+
+public:
+    FontRegistry(const FontRegistry&) = delete;
+    FontRegistry& operator=(const FontRegistry&) = delete;
+    ~FontRegistry();
+
+    static FontRegistry& getInstance();
+
+    // Shared font, loaded on first use. Returns nullptr if it can't be loaded
+    TTF_Font* getFont(const std::string& path, int size,
+                      int hinting = TTF_HINTING_NORMAL, int style = TTF_STYLE_NORMAL);
+
+    // Close every font, pointers returned so far must not be used anymore
+    void clear();
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <SDL/SDL.h>
+#include <SDL/SDL_ttf.h>
+
+/**
+ * Text engine that rasterizes every glyph once and composes strings from
+ * it. Glyphs are packed on shelves in atlas pages, one set of pages per
+ * (font, color), with premultiplied alpha, and strings are drawn by
+ * blending glyph rectangles with kerning applied. Text is UTF-8; SDL_ttf only handles the Basic
+ * Multilingual Plane, which covers CJK ideographs and kana.
+ */
+class GlyphAtlas {
+private:
+    static const int PAGE_SIZE = 512;
+
+    struct Metrics {
+        int minx;
+        int maxx;
+        int maxy;
+        int advance;
+    };
+
+    // Layout data of a font, shared by every color
+    struct FontData {
+        int ascent = 0;
+        std::unordered_map<Uint16, Metrics> metrics;
+        std::unordered_map<std::uint32_t, int> kerning;
+    };
+
+    struct Glyph {
+        int page;
+        SDL_Rect rect;
+    };
+
+    // Rasterized glyphs of a font in one color
+    struct Pages {
+        std::vector<SDL_Surface*> pages;
+        int pageSize = PAGE_SIZE;
+        int shelfX = 0;
+        int shelfY = 0;
+        int shelfHeight = 0;
+        std::unordered_map<Uint16, Glyph> glyphs;
+    };
+
+    struct PagesKeyHash {
+        std::size_t operator()(const std::pair<TTF_Font*, Uint32>& key) const {
+            return std::hash<const void*>()(key.first) ^ (std::hash<Uint32>()(key.second) << 1);
+        }
+    };
+
+    std::unordered_map<TTF_Font*, FontData> fonts;
+    std::unordered_map<std::pair<TTF_Font*, Uint32>, Pages, PagesKeyHash> atlases;
+
+    // Code points of the last decoded string, reused to avoid allocations
+    std::vector<Uint16> codepoints;
+
+    std::size_t bytes = 0;
+    std::uint64_t glyphCount = 0;
+    std::uint64_t misses = 0;
+
+    FontData& getFontData(TTF_Font* font);
+    const Metrics& getMetrics(TTF_Font* font, FontData& data, Uint16 ch);
+    int getKerning(TTF_Font* font, FontData& data, Uint16 left, Uint16 right);
+    const Glyph* getGlyph(TTF_Font* font, Pages& atlas, Uint16 ch, SDL_Color color);
+
+    void decode(const std::string& text);
+
+public:
+    GlyphAtlas() = default;
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    // Width in pixels of an UTF-8 string, without rasterizing it
+    int getTextWidth(TTF_Font* font, const std::string& text);
+
+    // Draw an UTF-8 string with its top left corner at x, y. The clip
+    // rectangle of the destination applies. Returns the width drawn
+    int drawText(SDL_Surface* dst, TTF_Font* font, const std::string& text,
+                 SDL_Color color, int x, int y);
+
+    // Drop every glyph, needed when the fonts close
+    void clear();
+
+    std::size_t getBytes() const { return bytes; }
+    std::uint64_t getGlyphCount() const { return glyphCount; }
+    std::uint64_t getMisses() const { return misses; }
+};
@@ -1,5 +1,4 @@
 #pragma once
-#include <boost/property_tree/ptree.hpp>
 #include <iostream>
 #include <string>
 #include <unordered_map>
@@ -8,13 +7,15 @@
 #include <vector>
 #include <memory>
 
+#include "IniFile.h"
+
 
 class I18n {
 private:
 
     std::string i18nFilepath;
 
-    boost::property_tree::ptree mainPt;
+    IniFile iniFile;
 
     std::set<std::string> languages;
 
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include <SDL/SDL.h>
+
+#include "ThumbnailStore.h"
+
+// An image to decode, scaled to fit in width x height keeping its aspect
+// ratio. A size of 0 keeps the image as it is
+struct ImageRequest {
+    std::string path;
+    int width = 0;
+    int height = 0;
+};
+
+// A decoded image, surface is nullptr when the file is missing or can't be
+// decoded. The surface is in the store format when a store is set
+struct ImageResult {
+    std::string path;
+    SDL_Surface* surface = nullptr;
+};
+
+/**
+ * Decodes and scales images on a background thread, so the UI never waits
+ * on PNG inflate or resampling. Only the most recent set of requests is
+ * kept: requests not started yet are dropped as soon as new ones arrive.
+ */
+class ImageLoader {
+private:
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+
+    std::deque<ImageRequest> pending;
+    std::vector<ImageResult> finished;
+    bool busy = false;
+    bool stopping = false;
+
+    std::shared_ptr<const ThumbnailStore> store;
+
+    void run();
+    static SDL_Surface* load(const ImageRequest& request, const ThumbnailStore* store);
+
+public:
+    ImageLoader();
+    ~ImageLoader();
+
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+
+    // Keep scaled images in a store, so they are decoded only once
+    void setStore(std::shared_ptr<const ThumbnailStore> store);
+
+    // Replace the pending requests, most important first
+    void request(std::vector<ImageRequest> requests);
+
+    // Take a finished image, the caller owns its surface
+    bool poll(ImageResult& result);
+
+    // True while requests are pending or being decoded
+    bool isBusy() const;
+
+    // Decode and scale an image on the calling thread, into the given
+    // format or 32 bpp ARGB when there is none
+    static SDL_Surface* decode(const ImageRequest& request, const SDL_PixelFormat* format = nullptr);
+};
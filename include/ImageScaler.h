@@ -0,0 +1,28 @@
+#pragma once
+#include <SDL/SDL.h>
+
+/**
+ * Resamples images straight into a target pixel format, without a 32 bpp
+ * intermediate surface. Shrinking by two or more averages the area each
+ * pixel covers (box filter), anything else is bilinear. Filtering is
+ * separable and fixed point; the inner loops use NEON or SSE2 when the
+ * target has them and plain C++ otherwise.
+ */
+class ImageScaler {
+public:
+    // New surface of width x height in the given format, nullptr on failure.
+    // Direct color formats only, palettes are not supported
+    static SDL_Surface* scale(SDL_Surface* source, int width, int height,
+                              const SDL_PixelFormat& format);
+
+    // Scale to fit in boxWidth x boxHeight keeping the aspect ratio
+    static SDL_Surface* fit(SDL_Surface* source, int boxWidth, int boxHeight,
+                            const SDL_PixelFormat& format);
+
+    // Pixel format with shifts and losses derived from the masks
+    static SDL_PixelFormat makeFormat(int bitsPerPixel, Uint32 rmask, Uint32 gmask,
+                                      Uint32 bmask, Uint32 amask);
+
+    // 32 bpp ARGB, what images are scaled to when no format is asked for
+    static SDL_PixelFormat getDefaultFormat();
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Read-only INI file. The file is mapped into memory and sections, keys and
+ * values are views into the mapping, so reading one allocates only the
+ * entry index. Views stay valid for the lifetime of the IniFile.
+ *
+ * The syntax is the one boost::property_tree::ini_parser accepts: ';' and
+ * '#' comment lines, trimmed keys and values, no duplicate sections or keys,
+ * no section named like a top level key, empty sections dropped and no BOM
+ * skipping. "[]" is a section named "", apart from the top level keys.
+ * Errors throw ini_parser_error as read_ini does.
+ */
+class IniFile {
+public:
+    struct Entry {
+        std::string_view key;
+        std::string_view value;
+    };
+
+    struct Section {
+        std::string_view name;
+        const Entry* begin;
+        const Entry* end;
+    };
+
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+
+    // Entries in file order, the top level keys first, then grouped by
+    // section
+    std::vector<Entry> entries;
+    Section topLevel = {};
+    std::vector<Section> sections;
+
+    // Entries sorted by key inside each section, for lookups
+    std::vector<std::uint32_t> sortedEntries;
+
+    void parse(const std::string& path);
+    const Section* findSection(std::string_view name) const;
+    bool find(const Section& section, std::string_view key, std::string_view& value) const;
+
+public:
+    explicit IniFile(const std::string& path);
+    ~IniFile();
+
+    IniFile(const IniFile&) = delete;
+    IniFile& operator=(const IniFile&) = delete;
+
+    // Keys before the first section
+    const Section& getTopLevel() const { return topLevel; }
+    const std::vector<Section>& getSections() const { return sections; }
+
+    // Value of section.key, false when missing
+    bool find(std::string_view section, std::string_view key, std::string_view& value) const;
+
+    // Same with a "section.key" path, split at the first dot like ptree
+    // paths. A path without a dot is a top level key
+    bool find(std::string_view path, std::string_view& value) const;
+
+    // Items of a delimited list, std::getline style: no trailing empty item
+    static std::vector<std::string_view> split(std::string_view value, char delimiter = ',');
+};
@@ -1,95 +1,166 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
 
+#include "Catalog.h"
+
+class Menu;
+
+/**
+ * Rom, Folder and Section are lightweight handles into a Menu. The menu only
+ * stores index ranges; every string is read in place from the catalog that
+ * MenuCache maps, so the library exists once in memory and the accessors
+ * never allocate.
+ */
 class Rom {
 private:
-    std::string name;
-    std::string path;
+    const Menu* menu;
+    std::uint32_t position;
 public:
-    Rom(const std::string& name, const std::string& path) 
-        : name(name), path(path) {}
+    Rom(const Menu& menu, std::uint32_t position)
+        : menu(&menu), position(position) {}
 
-    std::string getTitle() const {
-        return name;
-    }
+    std::string_view getTitle() const;
+    std::string_view getPath() const;
+    std::string_view getCore() const;
 
-    std::string getPath() const {
-        return path;
-    }
+    // Index of the rom in the catalog
+    std::size_t getItem() const;
+};
 
+// Read only view over a contiguous range of handles
+template <typename T>
+class MenuRange {
+private:
+    const Menu* menu;
+    std::uint32_t first;
+    std::uint32_t count;
+public:
+    class iterator {
+    private:
+        const Menu* menu;
+        std::uint32_t position;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = T;
+
+        iterator(const Menu* menu, std::uint32_t position)
+            : menu(menu), position(position) {}
+
+        T operator*() const { return T(*menu, position); }
+        iterator& operator++() { position++; return *this; }
+        iterator operator++(int) { iterator it = *this; position++; return it; }
+        bool operator==(const iterator& other) const { return position == other.position; }
+        bool operator!=(const iterator& other) const { return position != other.position; }
+    };
+
+    MenuRange(const Menu& menu, std::uint32_t first, std::uint32_t count)
+        : menu(&menu), first(first), count(count) {}
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T operator[](std::size_t index) const { return T(*menu, first + index); }
+
+    iterator begin() const { return iterator(menu, first); }
+    iterator end() const { return iterator(menu, first + count); }
 };
 
 class Folder {
 private:
-    std::string name;
-    std::vector<Rom> roms;
+    const Menu* menu;
+    std::uint32_t position;
 public:
-    Folder(const std::string& name) : name(name) {}
-
-    void addRom(const Rom& rom) {
-        roms.push_back(rom);
-    }
-
-    std::string getTitle() const {
-        return name;
-    }
-
-    const std::vector<Rom>& getRoms() const {
-        return roms;
-    }
+    Folder(const Menu& menu, std::uint32_t position)
+        : menu(&menu), position(position) {}
 
+    std::string_view getTitle() const;
+    MenuRange<Rom> getRoms() const;
 };
 
 class Section {
 private:
-    std::string name;
-    std::vector<Folder> folders;
+    const Menu* menu;
+    std::uint32_t position;
 public:
-    Section(const std::string& name) : name(name) {}
+    Section(const Menu& menu, std::uint32_t position)
+        : menu(&menu), position(position) {}
 
-    void addFolder(const Folder& folder) {
-        folders.push_back(folder);
-    }
+    std::string_view getTitle() const;
+    MenuRange<Folder> getFolders() const;
+};
 
-    std::string getTitle() const {
-        return name;
-    }
+class Menu {
+private:
+    friend class Rom;
+    friend class Folder;
+    friend class Section;
 
-    Folder* getFolderByName(const std::string& name) {
-        for (auto& sys : folders) {
-            if (sys.getTitle() == name) {
-                return &sys;
-            }
-        }
-        return nullptr;
-    }
+    struct FolderRange {
+        std::uint32_t firstRom;
+        std::uint32_t romCount;
+    };
 
-    const std::vector<Folder>& getFolders() const {
-        return folders;
-    }
+    struct SectionRange {
+        std::uint32_t firstFolder;
+        std::uint32_t folderCount;
+    };
 
-};
+    const Catalog* catalog = nullptr;
 
+    // Catalog item indices grouped by folder, folders grouped by section
+    std::vector<std::uint32_t> romItems;
+    std::vector<FolderRange> folders;
+    std::vector<SectionRange> sections;
 
-class Menu {
-private:
-    std::vector<Section> sections;
 public:
-    void addSection(const Section& section) {
-        sections.push_back(section);
-    }
-
-    Section* getSectionByName(const std::string& name) {
-        for (auto& sec : sections) {
-            if (sec.getTitle() == name) {
-                return &sec;
-            }
-        }
-        return nullptr;
-    }
+    // Group the catalog items by section and folder, keeping the order in
+    // which they first appear. The catalog must outlive the menu; it may be
+    // remapped as long as the item order does not change
+    void build(const Catalog& catalog);
 
-    const std::vector<Section>& getSections() const {
-        return sections;
+    MenuRange<Section> getSections() const {
+        return MenuRange<Section>(*this, 0, sections.size());
     }
 };
+
+inline std::string_view Rom::getTitle() const {
+    return menu->catalog->getRom(getItem());
+}
+
+inline std::string_view Rom::getPath() const {
+    return menu->catalog->getPath(getItem());
+}
+
+inline std::string_view Rom::getCore() const {
+    return menu->catalog->getCore(getItem());
+}
+
+inline std::size_t Rom::getItem() const {
+    return menu->romItems[position];
+}
+
+inline std::string_view Folder::getTitle() const {
+    return menu->catalog->getFolder(menu->romItems[menu->folders[position].firstRom]);
+}
+
+inline MenuRange<Rom> Folder::getRoms() const {
+    const Menu::FolderRange& folder = menu->folders[position];
+    return MenuRange<Rom>(*menu, folder.firstRom, folder.romCount);
+}
+
+inline std::string_view Section::getTitle() const {
+    const Menu::SectionRange& section = menu->sections[position];
+    return menu->catalog->getSection(menu->romItems[menu->folders[section.firstFolder].firstRom]);
+}
+
+inline MenuRange<Folder> Section::getFolders() const {
+    const Menu::SectionRange& section = menu->sections[position];
+    return MenuRange<Folder>(*menu, section.firstFolder, section.folderCount);
+}
@@ -1,36 +1,46 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
 // #include "MenuItem.h"
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
-namespace pt = boost::property_tree;
+#include "Catalog.h"
 
-struct CachedMenuItem {
-    std::string section;
-    std::string folder;
-    std::string rom;
-    std::string path;
-    std::string core;
-};
+namespace pt = boost::property_tree;
 
 class MenuCache {
 private:
-    std::unordered_map<std::string, std::vector<CachedMenuItem>> inMemoryCache;
+    Catalog catalog;
+    std::string catalogPath;
+
+    // Where a catalog goes when its own location cannot be written
+    static std::string getFallbackPath(const std::string& filePath);
 
 public:
     MenuCache() = default;
-    
-    // Save the given data to cache
-    void saveToCache(const std::string& filePath, const std::vector<CachedMenuItem>& data);
 
-    // Load data from cache
-    std::vector<CachedMenuItem> loadFromCache(const std::string& filePath);
+    // Save the given data to the binary catalog and map it. When the file
+    // cannot be written the data goes to a temporary catalog instead, which
+    // is mapped in its place; false tells the data was not persisted
+    bool saveToCache(const std::string& filePath, const std::vector<CachedMenuItem>& data,
+                     const std::vector<CachedDirectory>& directories = {});
+
+    // Map the binary catalog, items are read in place from the mapping
+    const Catalog& loadFromCache(const std::string& filePath);
 
     // Update cache data
     bool updateCacheItem(const std::string& filePath, const std::string& itemPath, const std::string& newCore);
 
     // Check if cache file exists
     bool cacheExists(const std::string& filePath);
+
+    // JSON representation of the cache, kept for debugging and to migrate
+    // caches written before the binary catalog existed
+    bool exportToJSON(const std::string& filePath);
+    bool importFromJSON(const std::string& filePath,
+                        std::vector<CachedMenuItem>& data,
+                        std::vector<CachedDirectory>& directories);
 };
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <algorithm>
 #include <SDL/SDL.h>
 #include <SDL/SDL_ttf.h>
@@ -11,16 +12,23 @@
 #include "Theme.h"
 #include "HelperUtils.h"
 #include "Settings.h"
-
-class RenderComponent {
+#include "Menu.h"
+#include "FontRegistry.h"
+#include "TextCache.h"
+#include "GlyphAtlas.h"
+#include "ImageLoader.h"
+#include "ThumbnailCache.h"
+#include "AlphaBlend.h"
+
+class RenderComponent : public ILanguageObserver {
 private:
     SDL_Surface* screen;
     TTF_Font* font;
     Configuration& cfg;
     Theme& theme;
+    const ThemeLayout& layout;
     HelperUtils helper;
     SDL_Surface* thumbnail = nullptr;
-    SDL_Surface* tmpThumbnail = nullptr;
     SDL_Surface* background = nullptr;
     SDL_Surface* currentBackground = nullptr;
 
@@ -28,6 +36,13 @@ private:
     std::string lastFolder;
     int lastRom = -1;
 
+    // Rom list page on screen. Aliases, folder title and page number are
+    // resolved once per page, so drawing the list does not allocate
+    std::size_t pageFirstItem = SIZE_MAX;
+    std::vector<std::string> pageAliases;
+    std::string pageTitle;
+    std::string pageInfo;
+
     // Text scroll
     int scrollPixelPosition = 0;
     Uint32 scrollEndTime = 0;
@@ -37,26 +52,95 @@ private:
     static const Uint32 SCROLL_SPEED = 600;
     static const Uint32 END_SCROLL_PAUSE = 3000;
 
+    // Set while something on screen moves on its own, like a scrolling title
+    bool animating = false;
+
+    // Dirty region tracking. After input the whole screen is redrawn, once
+    // per screen buffer. Otherwise only regions that change on their own are
+    // repainted, and a frame without changes is not presented at all
+    int screenBuffers = 1;
+    int fullRedrawFrames = 1;
+    std::vector<SDL_Rect> dirtyRects;
+
+    // Selected rom row, repainted on its own while its title scrolls
+    int selectedRow = -1;
+    int selectedTitleWidth = 0;
+    SDL_Rect selectedRowRect = {0, 0, 0, 0};
+    int scrollFramesLeft = 0;
+
+    // Thumbnail of the selected rom, decoded in the background. The art of
+    // the previous rom stays on screen until it is ready
+    ImageLoader thumbnailLoader;
+    std::string thumbnailPath;
+    std::size_t thumbnailItem = SIZE_MAX;
+    bool thumbnailPending = false;
+    int thumbnailFramesLeft = 0;
+
+    // Directional prefetch around the selected rom
+    static const Uint32 FAST_SCROLL_INTERVAL = 150;
+    int prefetchAhead = 4;
+    int prefetchBehind = 1;
+    int thumbnailIndex = -1;
+    Uint32 thumbnailSelectTime = 0;
+    unsigned int thumbnailHits = 0;
+    unsigned int thumbnailMisses = 0;
+
+    void reportThumbnailHitRate();
+
+    // FPS counter, repainted over a copy of what lies under it
+    SDL_Surface* fpsBacking = nullptr;
+    SDL_Rect fpsRect = {0, 0, 0, 0};
+    std::string lastFpsText;
+    int fpsFramesLeft = 0;
+
+    void markDirty(const SDL_Rect& rect);
+    void restoreBackground(const SDL_Rect& rect);
+    bool updateScroll();
+    void drawSelectedTitle();
+
+    std::string getThumbnailPath(const std::string& romPath);
+    SDL_Rect getArtRect();
+    bool updateThumbnail();
+    void setThumbnail(SDL_Surface* surface);
+    bool isDisplayFormat(const SDL_Surface* surface) const;
+    void drawThumbnail();
+
     int screenHeight;
     int screenWidth;
 
     std::string currentBackgroundPath;
 
-    static std::unordered_map<std::string, SDL_Surface*> thumbnailCache;
+    // Decoded thumbnails, bounded by the bytes they hold
+    ThumbnailCache thumbnailCache;
+
+    // Section titles over their translucent band, by section name. Built
+    // on first use and dropped when the theme or the language changes
+    std::unordered_map<std::string, SDL_Surface*> sectionOverlays;
+
+    SDL_Surface* getSectionOverlay(const std::string& name);
+    void clearSectionOverlays();
+
+    // Section backgrounds and folder logos, with the neighbours of the one
+    // on screen decoded ahead
+    ThumbnailCache backgroundCache;
+    ImageLoader backgroundLoader;
+    std::vector<std::string> backgroundPrefetch;
+
+    std::string getSectionBackgroundPath(std::string_view name);
+    std::string getFolderLogoPath(std::string_view name);
+    void prefetchBackgrounds(std::vector<std::string> paths);
+    void updateBackgrounds();
+
+    // Rendered text, so labels are only rasterized once
+    TextCache textCache;
+
+    // Glyphs of the rom list, rom names are composed from them
+    GlyphAtlas glyphAtlas;
     static std::unordered_map<std::string, std::string> aliasMap;
 
     // Common method to render text on screen
     void renderText(const std::string& text, Sint16 x, Sint16 y, SDL_Color color, int align = 0) {
-        SDL_Surface* rawTextSurface = TTF_RenderText_Blended(font, text.c_str(), color);
-        if (!rawTextSurface) {
-            // Handle the error, e.g., print an error message
-            return;
-        }
-
-        // Convert the surface to the display format while preserving alpha
-        SDL_Surface* textSurface = SDL_DisplayFormatAlpha(rawTextSurface);
-        SDL_FreeSurface(rawTextSurface);  // Free the original surface
-
+        SDL_Surface* textSurface = textCache.get(font, text, color);
         if (!textSurface) {
             // Handle the error, e.g., print an error message
             return;
@@ -82,9 +166,7 @@ private:
 
 
         SDL_Rect position = {x, y, 0, 0};  // Assuming width and height are determined by the textSurface
-        SDL_BlitSurface(textSurface, NULL, screen, &destRect);
-
-        SDL_FreeSurface(textSurface);  // Free the converted surface
+        AlphaBlend::blit(textSurface, nullptr, screen, &destRect);
     }
 
     void old_setBackground(const std::string& backgroundPath) {
@@ -112,22 +194,30 @@ private:
     }
 
     void setBackground(const std::string& backgroundPath) {
-        if (background) {
-            SDL_FreeSurface(background);
-            background = nullptr;
+        // Neighbours decoded in the background may have brought it in
+        updateBackgrounds();
+
+        SDL_Surface* surface = nullptr;
+        if (!backgroundCache.get(backgroundPath, surface)) {
+            SDL_Surface* loadedSurface = IMG_Load(backgroundPath.c_str());
+            if(loadedSurface) {
+                surface = SDL_DisplayFormat(loadedSurface);
+                SDL_FreeSurface(loadedSurface);
+            }
+            if (!surface) {
+                std::cerr << "Failed to load background: " << IMG_GetError() << std::endl;
+            }
+            backgroundCache.put(backgroundPath, surface);
         }
 
-        SDL_Surface* loadedSurface = IMG_Load(backgroundPath.c_str());
-        if(loadedSurface) {
-            background = SDL_DisplayFormat(loadedSurface);
-            SDL_FreeSurface(loadedSurface);
-        } else {
-            std::cerr << "Failed to load background: " << IMG_GetError() << std::endl;
+        // Hold a reference, the cache may evict the surface while it is shown
+        if (surface) {
+            surface->refcount++;
         }
-        if (!background) {
-            std::cerr << "Failed to load background: " << IMG_GetError() << std::endl;
+        if (background) {
+            SDL_FreeSurface(background);
         }
-
+        background = surface;
         currentBackground = background;
     }
 
@@ -144,9 +234,58 @@ public:
         lastSection = "";
         lastFolder = "";
         lastRom = -1;
+        pageFirstItem = SIZE_MAX;
         selectTime = SDL_GetTicks();
         scrollPixelPosition = 0;
         scrollEndTime = 0;
+        animating = false;
+        selectedRow = -1;
+        scrollFramesLeft = 0;
+        thumbnailItem = SIZE_MAX;
+        thumbnailPending = false;
+        thumbnailIndex = -1;
+        reportThumbnailHitRate();
+    }
+
+    // Fonts are owned by the FontRegistry, which drops them on theme change
+    void loadFonts() {
+        font = FontRegistry::getInstance().getFont(
+            layout.font,
+            layout.fontSize,
+            TTF_HINTING_NORMAL);  // or TTF_HINTING_LIGHT, TTF_HINTING_MONO, TTF_HINTING_NONE
+
+        // The FPS counter backing depends on the font height
+        if (fpsBacking) {
+            SDL_FreeSurface(fpsBacking);
+            fpsBacking = nullptr;
+        }
+    }
+
+    // Called once the new theme is loaded, every font has been released
+    void themeChanged() {
+        textCache.clear();
+        glyphAtlas.clear();
+        backgroundCache.clear();
+        backgroundPrefetch.clear();
+        clearSectionOverlays();
+        loadFonts();
+        resetValues();
+        invalidate();
+    }
+
+    // Redraw the whole screen on the next frames
+    void invalidate() {
+        fullRedrawFrames = screenBuffers;
+    }
+
+    bool needsFullRedraw() const {
+        return fullRedrawFrames > 0;
+    }
+
+    // True when the current screen needs to be redrawn at the full refresh
+    // rate even without input
+    bool isAnimating() const {
+        return animating || thumbnailPending;
     }
 
     void initialize() {
@@ -157,9 +296,9 @@ public:
         }
 
         screen = SDL_SetVideoMode(
-            cfg.getInt(Configuration::SCREEN_WIDTH),
-            cfg.getInt(Configuration::SCREEN_HEIGHT),
-            cfg.getInt(Configuration::SCREEN_DEPTH),
+            cfg.getInt(Configuration::Key::SCREEN_WIDTH),
+            cfg.getInt(Configuration::Key::SCREEN_HEIGHT),
+            cfg.getInt(Configuration::Key::SCREEN_DEPTH),
 #ifndef TRIPLE_BUFFER
             SDL_HWSURFACE | SDL_DOUBLEBUF);
 #else
@@ -171,17 +310,34 @@ public:
             exit(1);
         }
 
+        // The driver may fall back to a single buffered shadow surface
+        screenBuffers = 1;
+        if (screen->flags & SDL_DOUBLEBUF) {
+#ifndef TRIPLE_BUFFER
+            screenBuffers = 2;
+#else
+            screenBuffers = 3;
+#endif
+        }
+        invalidate();
+
+        // Scaled thumbnails are kept on disk in the screen format, an empty
+        // path disables it
+        std::string thumbnailStorePath = cfg.get(Configuration::Key::THUMBNAIL_DISK_CACHE, "caches/thumbnails");
+        if (!thumbnailStorePath.empty()) {
+            std::uint64_t storeBudget = static_cast<std::uint64_t>(
+                std::max(0, cfg.getInt(Configuration::Key::THUMBNAIL_DISK_CACHE_MB, 64))) * 1024 * 1024;
+            thumbnailLoader.setStore(std::make_shared<ThumbnailStore>(
+                cfg.get(Configuration::Key::HOME_PATH) + "/" + thumbnailStorePath, *screen->format, storeBudget));
+        }
+
         if (TTF_Init() == -1) {
             std::cerr << "Unable to initialize TTF: " << TTF_GetError() << std::endl;
             SDL_Quit();
             exit(1);
         }
 
-        font = TTF_OpenFont(
-            theme.getValue(Configuration::THEME_FONT, true).c_str(),
-            theme.getIntValue("GENERAL.font_size"));
-        TTF_SetFontHinting(font, TTF_HINTING_NORMAL);  // or TTF_HINTING_LIGHT, TTF_HINTING_MONO, TTF_HINTING_NONE
-        TTF_SetFontKerning(font, 1); // 1 to enable, 0 to disable
+        loadFonts();
 
         // Enable keyboard repeat (only for keys, not for buttons)
         SDL_EnableKeyRepeat(SDL_DEFAULT_REPEAT_DELAY, SDL_DEFAULT_REPEAT_INTERVAL);
@@ -189,14 +345,31 @@ public:
         SDL_ShowCursor(SDL_DISABLE);
     }
 
+    // ILanguageObserver methods
+    void languageChanged() override;
+    std::string getName() override { return "RenderComponent"; }
+
     void drawSection(const std::string& name, int numSystems);
     void drawFolder(const std::string& name, const std::string& path, int numRoms);
-    void drawRomList(const std::string& folderName, const std::vector<std::pair<std::string, std::string>>& romData, int currentRomIndex);
+
+    // Decode the backgrounds of the sections or the logos of the folders
+    // next to the one on screen, so moving to them doesn't wait on a decode
+    void prefetchSections(std::string_view previous, std::string_view next);
+    void prefetchFolders(std::string_view previous, std::string_view next);
+    void drawRomList(const Folder& folder, int currentRomIndex);
     void drawAppSettings(const std::string& settingsTitle, std::vector<Settings::I18nSetting> settingList, int currentSettingIndex);
     void drawFolderSettings(const std::string& settingsTitle, std::vector<Settings::I18nSetting> settingList, int currentSettingIndex);
     void drawRomSettings(const std::string& settingsTitle, std::vector<Settings::I18nSetting> settingList, int currentSettingIndex);
-    void loadThumbnail(const std::string& romPath);
-    void printFPS(int fps);
+    void loadThumbnail(const MenuRange<Rom>& roms, int currentRomIndex);
+    void printFPS(int fps, int cpuLoad, int textMisses);
+
+    const TextCache& getTextCache() const {
+        return textCache;
+    }
+
+    const GlyphAtlas& getGlyphAtlas() const {
+        return glyphAtlas;
+    }
     void loadAliases();
     std::string getAlias(const std::string& title);
     
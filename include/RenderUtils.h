@@ -6,19 +6,31 @@
 #include <SDL/SDL_ttf.h>
 
 #include "Theme.h"
+#include "FontRegistry.h"
 
 
 class RenderUtils {
 private:
     Theme theme;
-    TTF_Font* m_font;
+    TTF_Font* m_font = nullptr;
     std::string m_fontPath;
-    int m_fontSize;
-    TTF_Font* generalFont;
-    TTF_Font* textFont;
+    int m_fontSize = 0;
+
+    // Fonts are looked up in the FontRegistry on use, so they stay valid
+    // across theme changes
+    std::string generalFontPath;
+    std::string textFontPath;
+    int fontSize = 0;
 
     static RenderUtils* instance;
 
+    TTF_Font* getFont() {
+        if (!m_fontPath.empty()) {
+            return FontRegistry::getInstance().getFont(m_fontPath, m_fontSize);
+        }
+        return m_font;
+    }
+
 public:
     static const int LEFT = 0;
     static const int CENTER = 1;
@@ -30,29 +42,22 @@ public:
         
         instance = this;
         
-        generalFont = TTF_OpenFont(theme.getValue(Configuration::THEME_FONT, true).c_str(),theme.getIntValue("GENERAL.font_size"));
-        if (!generalFont) {
-            // Handle font loading error appropriately
-            std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        }
-
-        textFont = TTF_OpenFont(theme.getValue("GENERAL.textX_font", true).c_str(),theme.getIntValue("GENERAL.font_size"));
-        if (!textFont) {
-            // Handle font loading error appropriately
-            std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-        }
+        const ThemeLayout& layout = theme.getLayout();
+        generalFontPath = layout.font;
+        textFontPath = layout.textFont;
+        fontSize = layout.fontSize;
 
-        m_font = generalFont;
+        m_fontPath = generalFontPath;
+        m_fontSize = fontSize;
     }
 
-    // Constructor to initialize with a font
+    // Constructor to initialize with a font, owned by the caller
     RenderUtils(Theme& theme, TTF_Font* font) : theme(theme), m_font(font) {}
 
     // Constructor to initialize with font path and size
     RenderUtils(Theme& theme, std::string fontPath, int fontSize) 
         : theme(theme), m_fontPath(fontPath), m_fontSize(fontSize) {
-        m_font = TTF_OpenFont(fontPath.c_str(), fontSize);
-        if (!m_font) {
+        if (!FontRegistry::getInstance().getFont(fontPath, fontSize)) {
             // Handle font loading error appropriately
             std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
         }
@@ -72,14 +77,13 @@ public:
         return instance;
     }
 
-    ~RenderUtils() {
-        if(m_font) {
-            TTF_CloseFont(m_font);
-        }
-    }
-
     void renderText(SDL_Surface* screen, const std::string& font, const std::string& text, int x, int y, int w, int h, SDL_Color color, int align = LEFT) {
-        SDL_Surface* textSurface = TTF_RenderText_Blended(font == "generalFont" ? generalFont : textFont, text.c_str(), color);
+        TTF_Font* ttfFont = FontRegistry::getInstance().getFont(
+            font == "generalFont" ? generalFontPath : textFontPath, fontSize);
+        SDL_Surface* textSurface = TTF_RenderUTF8_Blended(ttfFont, text.c_str(), color);
+        if (!textSurface) {
+            return;
+        }
         
         SDL_Rect destRect;
         switch(align) {
@@ -104,14 +108,11 @@ public:
 
     // Method to set a new font and size
     void setFont(const std::string& fontPath, int size) {
-        // if (m_font) {
-        //     TTF_CloseFont(m_font);
-        // }
-        m_font = TTF_OpenFont(fontPath.c_str(), size);
-        if (!m_font) {
+        m_fontPath = fontPath;
+        m_fontSize = size;
+        if (!getFont()) {
             // Handle font loading error appropriately
             std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
         }
     }
 };
-
@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "FileManager.h"
+
+// A single rom directory to enumerate, tagged with the section and folder
+// it belongs to so the results can be merged back into the cache in order
+struct ScanJob {
+    std::string section;
+    std::string folder;
+    std::string directory;
+    // Modification time recorded by the previous scan, -1 if unknown.
+    // The directory is only enumerated again when its mtime differs
+    std::int64_t knownMtime = -1;
+};
+
+struct ScanResult {
+    std::vector<std::string> files;
+    std::int64_t mtime = 0;
+    bool unchanged = false;
+    unsigned int elapsedMs = 0;
+};
+
+class RomScanner {
+private:
+    FileManager& fileManager;
+    unsigned int maxThreads;
+
+    void scanJob(const ScanJob& job, ScanResult& result);
+
+public:
+    // maxThreads = 0 uses one worker per available core
+    RomScanner(FileManager& fileManager, unsigned int maxThreads = 0);
+
+    // Enumerate every job on the worker pool. Results are returned in the
+    // same order as the jobs, regardless of which worker finished first
+    std::vector<ScanResult> scan(const std::vector<ScanJob>& jobs);
+
+    unsigned int getThreadCount(std::size_t jobCount) const;
+};
@@ -3,12 +3,14 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <fstream>
+#include <filesystem>
 #include "I18n.h"
 #include "IObservers.h"
+#include "SystemRegistry.h"
 
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
-#include <boost/filesystem.hpp>
 
 class Configuration;
 
@@ -224,9 +226,12 @@ public:
 
 
 class SystemSettings : public Settings {
+private:
+    SystemRegistry& systems;
+
 public:
 
-    SystemSettings(Configuration& cfg, I18n& i18n, 
+    SystemSettings(Configuration& cfg, I18n& i18n, SystemRegistry& systems,
                    int minValue, int maxValue, int delta);
 
     std::vector<Settings::I18nSetting> getSystemSettings();
@@ -243,58 +248,61 @@ public:
     std::string getName() override;
 
     void generateCoreSettings() {
-        namespace fs = boost::filesystem;
         namespace pt = boost::property_tree;
 
-        std::string sectionGroupsPath = cfg.get(Configuration::HOME_PATH) + "/section_groups/";
-        pt::ptree root;
-
-        // Iterate over all .ini files in the section_groups directory
-        fs::directory_iterator end_itr; // default construction yields past-the-end
-        for (fs::directory_iterator itr(sectionGroupsPath); itr != end_itr; ++itr) {
-            if (fs::is_regular_file(itr->status()) && itr->path().extension() == ".ini") {
-                std::string iniFilePath = itr->path().string();
-
-                // Parse the ini file for folder names and their ConsoleData
-                std::map<std::string, ConsoleData> consoleDataMap = cfg.parseIniFile(iniFilePath);
-
-                for (const auto& pair : consoleDataMap) {
-                    const std::string& folderName = pair.first;
-                    const ConsoleData& consoleData = pair.second;
+        // coreSettings.json only changes with the section groups. The stamp
+        // holds the registry fingerprint it was generated from, so an
+        // unchanged setup costs no write to the SD card
+        std::string jsonFilePath = cfg.get(Configuration::Key::HOME_PATH) + "coreSettings.json";
+        std::string stampFilePath = cfg.get(Configuration::Key::HOME_PATH) + "caches/coreSettings.stamp";
+        std::string fingerprint = std::to_string(systems.getFingerprint());
+
+        std::string storedFingerprint;
+        std::ifstream stampFile(stampFilePath);
+        if (stampFile >> storedFingerprint && storedFingerprint == fingerprint
+            && std::filesystem::exists(jsonFilePath)) {
+            std::cout << "Section groups unchanged, keeping " << jsonFilePath << std::endl;
+            return;
+        }
 
-                    if (!consoleData.execs.empty()) {
-                        pt::ptree folderData, coresArray;
-                        std::string defaultCore;
+        pt::ptree root;
 
-                        for (const auto& exec : consoleData.execs) {
-                            std::string coreName = exec.substr(exec.find_last_of("/\\") + 1);
-                            coresArray.push_back(std::make_pair("", pt::ptree(coreName)));
+        // Every section group, from the registry
+        for (const SectionGroup& group : systems.getSections()) {
+            for (const SystemInfo& system : group.systems) {
+                if (!system.cores.empty()) {
+                    pt::ptree folderData, coresArray;
 
-                            if (defaultCore.empty()) {
-                                defaultCore = coreName;
-                            }
-                        }
+                    for (const auto& coreName : system.cores) {
+                        coresArray.push_back(std::make_pair("", pt::ptree(coreName)));
+                    }
 
-                        folderData.add_child("cores", coresArray);
-                        folderData.put("default_core", defaultCore);
+                    folderData.add_child("cores", coresArray);
+                    folderData.put("default_core", system.cores.front());
 
-                        // Add to the root node under the folderName
-                        root.add_child(folderName, folderData);
-                    }
+                    // Add to the root node under the folder name
+                    root.add_child(system.name, folderData);
                 }
             }
         }
 
-        // Write to single JSON file
-        std::string jsonFilePath = cfg.get(Configuration::HOME_PATH) + "coreSettings.json";
+        // Write to single JSON file, then the stamp, so an interrupted
+        // write is redone on the next start
         pt::write_json(jsonFilePath, root);
+
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(stampFilePath).parent_path(), ec);
+        std::ofstream(stampFilePath) << fingerprint << std::endl;
     }
 
 };
 
 class RomSettings : public Settings, public ILanguageObserver {
+private:
+    const SystemRegistry& systems;
+
 public:
-    RomSettings(Configuration& cfg, I18n& i18n, 
+    RomSettings(Configuration& cfg, I18n& i18n, const SystemRegistry& systems,
                 int minValue, int maxValue, int delta);
 
     std::vector<Settings::I18nSetting> getRomSettings();
@@ -353,21 +361,11 @@ public:
 public:
     void getCores(std::string sectionName, std::string folderName) {
 
-        std::map<std::string, ConsoleData> consoleDataMap = cfg.parseIniFile(cfg.get(Configuration::HOME_PATH) + "/section_groups/" + sectionName);
-
         cores.clear();
 
-        // Check if the parentTitle exists in the consoleDataMap
-        if (consoleDataMap.find(folderName) != consoleDataMap.end()) {
-            // Access the ConsoleData for the parentTitle
-            ConsoleData consoleData = consoleDataMap[folderName];
-
-            // Check if the execs vector is not empty
-            if (!consoleData.execs.empty()) {
-                for(auto exec: consoleData.execs) {
-                    cores.insert(exec.substr(exec.find_last_of("/\\") + 1));
-                }
-            }
+        // Cores of the folder, if the registry knows it
+        if (const SystemInfo* system = systems.find(sectionName, folderName)) {
+            cores.insert(system->cores.begin(), system->cores.end());
         }
 
         // By default we select the first core from the list
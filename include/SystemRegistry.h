@@ -0,0 +1,77 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// One console of a section group, as described by its section_groups ini
+struct SystemInfo {
+    std::string name;
+    std::vector<std::string> execs;
+    std::vector<std::string> romExts;
+    std::vector<std::string> romDirs;
+
+    // Launcher file names of the execs, in ini order. The first one is the
+    // default core
+    std::vector<std::string> cores;
+};
+
+// Consoles of one section_groups ini, sorted by name
+struct SectionGroup {
+    std::string file;
+    std::vector<SystemInfo> systems;
+    std::unordered_map<std::string, std::size_t> index;
+};
+
+/**
+ * Every section group and console, read once from the section_groups inis.
+ * systems.json fills in the execs, romDirs and romExts an ini leaves out,
+ * except for its consoles marked "enabled": false.
+ * Lookups by section and console are hash lookups; refresh() stats the
+ * sources and re-reads only the ones whose size or mtime changed.
+ */
+class SystemRegistry {
+private:
+    struct Source {
+        std::string path;
+        std::int64_t size;
+        std::int64_t mtime;
+
+        bool operator==(const Source& other) const {
+            return path == other.path && size == other.size && mtime == other.mtime;
+        }
+    };
+
+    std::string sectionGroupsPath;
+    std::string systemsJsonPath;
+
+    Source systemsJson;
+    std::vector<Source> iniSources;
+
+    std::vector<SectionGroup> sections;
+    std::unordered_map<std::string, std::size_t> sectionIndex;
+
+    // Defaults from systems.json by console name
+    std::unordered_map<std::string, SystemInfo> defaults;
+
+    static Source stat(const std::string& path);
+    std::vector<Source> listIniSources() const;
+    void loadDefaults();
+    SectionGroup loadSection(const std::string& path, const std::string& file) const;
+
+public:
+    SystemRegistry(const std::string& sectionGroupsPath, const std::string& systemsJsonPath);
+
+    // Re-read changed sources, true when anything was reloaded
+    bool refresh();
+
+    const std::vector<SectionGroup>& getSections() const { return sections; }
+
+    // Hash of the path, size and mtime of every source, for files derived
+    // from the registry to tell whether they are stale
+    std::uint64_t getFingerprint() const;
+
+    // nullptr when the section or console is unknown
+    const SectionGroup* findSection(const std::string& file) const;
+    const SystemInfo* find(const std::string& section, const std::string& system) const;
+};
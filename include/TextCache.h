@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <SDL/SDL.h>
+#include <SDL/SDL_ttf.h>
+
+/**
+ * LRU cache of rendered text, keyed by (font, text, color). Surfaces are
+ * kept in display format with premultiplied alpha, draw them with
+ * AlphaBlend::blit. The cache owns them; a surface stays valid until the
+ * next get() or clear().
+ */
+class TextCache {
+private:
+    struct Entry {
+        TTF_Font* font;
+        std::string text;
+        Uint32 color;
+        SDL_Surface* surface;
+        std::size_t bytes;
+    };
+
+    // The text of a key points to the string of its entry, lookups use a
+    // view of the caller's string so a hit does not allocate
+    struct Key {
+        TTF_Font* font;
+        std::string_view text;
+        Uint32 color;
+
+        bool operator==(const Key& other) const {
+            return font == other.font && color == other.color && text == other.text;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            std::size_t h = std::hash<std::string_view>()(key.text);
+            h ^= std::hash<const void*>()(key.font) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            h ^= std::hash<Uint32>()(key.color) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    // Most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+
+    std::size_t budget;
+    std::size_t bytes = 0;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+
+    static Uint32 packColor(SDL_Color color) {
+        return (color.r << 16) | (color.g << 8) | color.b;
+    }
+
+    void evict();
+
+public:
+    explicit TextCache(std::size_t budget);
+    ~TextCache();
+
+    TextCache(const TextCache&) = delete;
+    TextCache& operator=(const TextCache&) = delete;
+
+    // Rendered text in display format, nullptr if it can't be rendered
+    SDL_Surface* get(TTF_Font* font, const std::string& text, SDL_Color color);
+
+    // Drop every surface, needed when the fonts they were rendered with close
+    void clear();
+
+    std::size_t size() const { return entries.size(); }
+    std::size_t getBytes() const { return bytes; }
+    std::uint64_t getHits() const { return hits; }
+    std::uint64_t getMisses() const { return misses; }
+};
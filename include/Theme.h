@@ -6,10 +6,66 @@
 
 #include "Configuration.h"
 
+/**
+ * The theme values draw code reads every frame, compiled once when the
+ * theme loads. Paths are resolved against the theme directory; missing or
+ * malformed values keep the defaults below, so drawing never parses.
+ */
+struct ThemeLayout {
+    // Fonts
+    std::string font;
+    std::string textFont;
+    int fontSize = 24;
+
+    // Rom list
+    std::string background;
+    int gameListX = 0;
+    int gameListY = 0;
+    int gameListW = 0;
+    int items = 10;
+    int itemsSeparation = 20;
+    SDL_Color itemsFontColor = {255, 255, 255, 0};
+    SDL_Color selectedItemFontColor = {255, 255, 0, 0};
+
+    // Game art
+    int artX = 0;
+    int artY = 0;
+    int artMaxW = 0;
+    int artMaxH = 0;
+    int artTextDistanceFromPicture = 0;
+
+    // Folder name and page number
+    int text1X = 0;
+    int text1Y = 0;
+    int text1Alignment = 0;
+    int text2X = 0;
+    int text2Y = 0;
+    int text2Alignment = 0;
+
+    // Game count on the folder screen
+    bool displayGameCount = false;
+    int gameCountX = 0;
+    int gameCountY = 0;
+    int gameCountAlignment = 0;
+    SDL_Color gameCountFontColor = {255, 255, 255, 0};
+
+    // Section screen, backgrounds are <sectionGroupsPath><group>.png
+    std::string sectionGroupsPath;
+    bool displaySectionGroupName = false;
+
+    // Folder logos by folder name
+    std::unordered_map<std::string, std::string> logos;
+};
+
 class Theme {
 private:
     std::unordered_map<std::string, std::string> configValues;
     std::string baseThemePath;
+    ThemeLayout layout;
+
+    void compileLayout();
+    int parseInt(const std::string& key, int defaultValue) const;
+    SDL_Color parseColor(const std::string& key, SDL_Color defaultValue) const;
 
 public:
     Theme(std::string homePath, std::string themePath, std::string name, int screenWidth, int screenHeight);
@@ -22,4 +78,7 @@ public:
     std::set<std::string> getStringList(const std::string& key, char delimiter = ',') const;
     SDL_Color getColor(const std::string& key) const;
     std::string getThemePath() const;
+
+    // Stays at the same address across loadTheme calls
+    const ThemeLayout& getLayout() const { return layout; }
 };
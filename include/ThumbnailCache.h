@@ -1,22 +1,56 @@
 #pragma once
-#include <unordered_map>
 #include <string>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
 
 #include <SDL/SDL.h>
 
+/**
+ * LRU cache of decoded thumbnails keyed by image path and bounded by the
+ * pixel bytes it holds. Missing art is cached as nullptr so it isn't looked
+ * up again. The cache owns its surfaces; a caller that keeps one on screen
+ * across later put() calls must hold a reference (refcount) of its own.
+ */
 class ThumbnailCache {
 private:
-    std::unordered_map<std::string, SDL_Surface*> cache;
-    const size_t MAX_SIZE = 1000;  // adjust this based on your needs
+    struct Entry {
+        std::string path;
+        SDL_Surface* surface;
+        std::size_t bytes;
+    };
+
+    // Most recently used first
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    std::size_t budget;
+    std::size_t bytes = 0;
+
+    static std::size_t getSize(const std::string& path, const SDL_Surface* surface);
+    void evict();
 
 public:
-    SDL_Surface* get(const std::string& key);
+    explicit ThumbnailCache(std::size_t budget);
+    ~ThumbnailCache();
 
-    void set(const std::string& key, SDL_Surface* surface);
+    ThumbnailCache(const ThumbnailCache&) = delete;
+    ThumbnailCache& operator=(const ThumbnailCache&) = delete;
 
-    ~ThumbnailCache() {
-        for (auto& pair : cache) {
-            SDL_FreeSurface(pair.second);
-        }
+    // Look up a thumbnail and mark it as used. Returns false if the path was
+    // never cached, surface is nullptr if it has no art
+    bool get(const std::string& path, SDL_Surface*& surface);
+
+    // Whether the path is cached, without touching its position
+    bool contains(const std::string& path) const {
+        return index.find(path) != index.end();
     }
+
+    // Store a thumbnail, the cache takes ownership of the surface
+    void put(const std::string& path, SDL_Surface* surface);
+
+    void clear();
+
+    std::size_t size() const { return entries.size(); }
+    std::size_t getBytes() const { return bytes; }
 };
@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <ctime>
+
+#include <SDL/SDL.h>
+
+/**
+ * Thumbnail file layout, all values in host byte order:
+ *
+ *   ThumbnailFileHeader
+ *   source path (pathSize bytes)
+ *   pixels (pitch * height bytes)
+ *
+ * Pixels are already scaled to the art box and in the display format, so
+ * loading one is a read straight into a surface.
+ */
+struct ThumbnailFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::int64_t mtime;
+    std::uint16_t boxWidth;
+    std::uint16_t boxHeight;
+    std::uint16_t width;
+    std::uint16_t height;
+    std::uint32_t pitch;
+    std::uint32_t bitsPerPixel;
+    std::uint32_t rmask;
+    std::uint32_t gmask;
+    std::uint32_t bmask;
+    std::uint32_t amask;
+    std::uint32_t pathSize;
+    std::uint32_t reserved;
+};
+
+/**
+ * On-disk cache of scaled thumbnails. Files are named after the source path
+ * and the art box, and hold the source mtime, so an image that changes on
+ * disk is decoded again and overwrites its stale entry. Files of an old art
+ * box or of removed images are never read again, the store is pruned to its
+ * budget at startup, least recently written first.
+ */
+class ThumbnailStore {
+private:
+    static const char MAGIC[4];
+    static const std::uint32_t VERSION;
+
+    std::string directory;
+    SDL_PixelFormat format;
+
+    std::string getFilePath(const std::string& path, int boxWidth, int boxHeight) const;
+
+    // Remove the oldest files until the store fits in budget bytes
+    void prune(std::uint64_t budget) const;
+
+public:
+    // An empty directory disables the store
+    ThumbnailStore(const std::string& directory, const SDL_PixelFormat& format, std::uint64_t budget);
+
+    bool isEnabled() const { return !directory.empty(); }
+    const SDL_PixelFormat& getFormat() const { return format; }
+
+    // Cached thumbnail for the image, nullptr if missing or stale
+    SDL_Surface* load(const std::string& path, std::time_t mtime, int boxWidth, int boxHeight) const;
+
+    // Store a thumbnail, the surface must be in the store format
+    bool save(const std::string& path, std::time_t mtime, int boxWidth, int boxHeight,
+              SDL_Surface* surface) const;
+};
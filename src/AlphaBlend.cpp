@@ -0,0 +1,352 @@
+#include "AlphaBlend.h"
+#include <algorithm>
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && SDL_BYTEORDER == SDL_LIL_ENDIAN
+#include <arm_neon.h>
+#define BLEND_NEON
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BLEND_SSE2
+#endif
+
+namespace {
+
+// x / 255 rounded, exact for any product of two bytes
+inline unsigned div255(unsigned x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+#if defined(BLEND_SSE2)
+// d * inv / 255 for two pixels unpacked to 16 bit lanes, inv taken from the
+// alpha lane of each pixel
+inline __m128i scalePixels(__m128i d, __m128i inv) {
+    inv = _mm_shufflelo_epi16(inv, _MM_SHUFFLE(3, 3, 3, 3));
+    inv = _mm_shufflehi_epi16(inv, _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(d, inv), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// d * inv / 255 for 16 bit lanes and a constant inv
+inline __m128i scaleLanes(__m128i d, __m128i inv) {
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(d, inv), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+// Premultiplied pixels with alpha in the top byte over 32 bpp pixels that
+// share their color layout
+void blendRow32(const Uint32* src, Uint32* dst, int count) {
+    int i = 0;
+
+#if defined(BLEND_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi32(-1);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xff000000));
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+
+        // Text is mostly fully transparent or fully opaque pixels
+        __m128i alpha = _mm_and_si128(s, alphaMask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xffff) {
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, alphaMask)) == 0xffff) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+            continue;
+        }
+
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i inv = _mm_xor_si128(s, ones);
+        __m128i lo = scalePixels(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(inv, zero));
+        __m128i hi = scalePixels(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(inv, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(_mm_packus_epi16(lo, hi), s));
+    }
+#elif defined(BLEND_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t s = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+
+        // Text is mostly fully transparent or fully opaque pixels, the eight
+        // alphas of the block are tested as one 64 bit lane
+        uint64_t alpha = vget_lane_u64(vreinterpret_u64_u8(s.val[3]), 0);
+        if (alpha == 0) {
+            continue;
+        }
+        if (alpha == ~UINT64_C(0)) {
+            vst4_u8(reinterpret_cast<uint8_t*>(dst + i), s);
+            continue;
+        }
+
+        uint8x8x4_t d = vld4_u8(reinterpret_cast<const uint8_t*>(dst + i));
+        uint8x8_t inv = vmvn_u8(s.val[3]);
+        for (int c = 0; c < 4; c++) {
+            uint16x8_t t = vmull_u8(d.val[c], inv);
+            d.val[c] = vqadd_u8(s.val[c], vraddhn_u16(t, vrshrq_n_u16(t, 8)));
+        }
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + i), d);
+    }
+#endif
+
+    for (; i < count; i++) {
+        Uint32 s = src[i];
+        unsigned alpha = s >> 24;
+        if (alpha == 0) {
+            continue;
+        }
+        if (alpha == 255) {
+            dst[i] = s;
+            continue;
+        }
+
+        Uint32 d = dst[i];
+        unsigned inv = 255 - alpha;
+        Uint32 out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            unsigned c = ((s >> shift) & 0xff) + div255(((d >> shift) & 0xff) * inv);
+            out |= std::min(255u, c) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+// Premultiplied constant color, packed like the destination pixels
+void fillRow32(Uint32* dst, int count, Uint32 color, unsigned inv) {
+    int i = 0;
+
+#if defined(BLEND_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i invLanes = _mm_set1_epi16(inv);
+    const __m128i colors = _mm_set1_epi32(static_cast<int>(color));
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i lo = scaleLanes(_mm_unpacklo_epi8(d, zero), invLanes);
+        __m128i hi = scaleLanes(_mm_unpackhi_epi8(d, zero), invLanes);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(_mm_packus_epi16(lo, hi), colors));
+    }
+#elif defined(BLEND_NEON)
+    const uint8x8_t invLanes = vdup_n_u8(inv);
+    const uint8x16_t colors = vreinterpretq_u8_u32(vdupq_n_u32(color));
+    for (; i + 4 <= count; i += 4) {
+        uint8x16_t d = vld1q_u8(reinterpret_cast<const uint8_t*>(dst + i));
+        uint16x8_t lo = vmull_u8(vget_low_u8(d), invLanes);
+        uint16x8_t hi = vmull_u8(vget_high_u8(d), invLanes);
+        uint8x16_t scaled = vcombine_u8(vraddhn_u16(lo, vrshrq_n_u16(lo, 8)),
+                                        vraddhn_u16(hi, vrshrq_n_u16(hi, 8)));
+        vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), vqaddq_u8(scaled, colors));
+    }
+#endif
+
+    for (; i < count; i++) {
+        Uint32 d = dst[i];
+        Uint32 out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            unsigned c = ((color >> shift) & 0xff) + div255(((d >> shift) & 0xff) * inv);
+            out |= std::min(255u, c) << shift;
+        }
+        dst[i] = out;
+    }
+}
+
+inline Uint32 readPixel(const Uint8* p, int bytes) {
+    switch (bytes) {
+        case 2:
+            return *reinterpret_cast<const Uint16*>(p);
+        case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            return p[0] | (p[1] << 8) | (p[2] << 16);
+#else
+            return (p[0] << 16) | (p[1] << 8) | p[2];
+#endif
+        default:
+            return *reinterpret_cast<const Uint32*>(p);
+    }
+}
+
+inline void writePixel(Uint8* p, int bytes, Uint32 pixel) {
+    switch (bytes) {
+        case 2:
+            *reinterpret_cast<Uint16*>(p) = pixel;
+            break;
+        case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            p[0] = pixel;
+            p[1] = pixel >> 8;
+            p[2] = pixel >> 16;
+#else
+            p[0] = pixel >> 16;
+            p[1] = pixel >> 8;
+            p[2] = pixel;
+#endif
+            break;
+        default:
+            *reinterpret_cast<Uint32*>(p) = pixel;
+            break;
+    }
+}
+
+inline unsigned getChannel(Uint32 pixel, Uint32 mask, Uint8 shift, Uint8 loss) {
+    return ((pixel & mask) >> shift) << loss;
+}
+
+inline Uint32 setChannel(unsigned value, Uint8 shift, Uint8 loss) {
+    return (std::min(255u, value) >> loss) << shift;
+}
+
+// Blend premultiplied r, g, b over one pixel of any direct color format
+inline void blendPixel(Uint8* p, const SDL_PixelFormat* df,
+                       unsigned r, unsigned g, unsigned b, unsigned inv) {
+    int bytes = df->BytesPerPixel;
+    Uint32 d = readPixel(p, bytes);
+    Uint32 out = setChannel(r + div255(getChannel(d, df->Rmask, df->Rshift, df->Rloss) * inv), df->Rshift, df->Rloss)
+               | setChannel(g + div255(getChannel(d, df->Gmask, df->Gshift, df->Gloss) * inv), df->Gshift, df->Gloss)
+               | setChannel(b + div255(getChannel(d, df->Bmask, df->Bshift, df->Bloss) * inv), df->Bshift, df->Bloss)
+               | (d & df->Amask);
+    writePixel(p, bytes, out);
+}
+
+// Clip a width x height area at x, y against the destination clip
+// rectangle, moving the source offset along
+bool clip(const SDL_Surface* dst, int& x, int& y, int& width, int& height, int& srcX, int& srcY) {
+    const SDL_Rect& area = dst->clip_rect;
+    if (x < area.x) {
+        srcX += area.x - x;
+        width -= area.x - x;
+        x = area.x;
+    }
+    if (y < area.y) {
+        srcY += area.y - y;
+        height -= area.y - y;
+        y = area.y;
+    }
+    width = std::min(width, area.x + area.w - x);
+    height = std::min(height, area.y + area.h - y);
+    return width > 0 && height > 0;
+}
+
+}
+
+void AlphaBlend::premultiply(SDL_Surface* surface, const SDL_Rect* rect) {
+    if (!surface || surface->format->BytesPerPixel != 4 || !surface->format->Amask) {
+        return;
+    }
+
+    const SDL_PixelFormat* f = surface->format;
+    int x0 = rect ? std::max(0, static_cast<int>(rect->x)) : 0;
+    int y0 = rect ? std::max(0, static_cast<int>(rect->y)) : 0;
+    int x1 = rect ? std::min(surface->w, rect->x + rect->w) : surface->w;
+    int y1 = rect ? std::min(surface->h, rect->y + rect->h) : surface->h;
+
+    SDL_LockSurface(surface);
+    for (int y = y0; y < y1; y++) {
+        Uint32* row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + y * surface->pitch);
+        for (int x = x0; x < x1; x++) {
+            Uint32 p = row[x];
+            unsigned alpha = (p & f->Amask) >> f->Ashift;
+            if (alpha == 255) {
+                continue;
+            }
+            row[x] = (div255(((p & f->Rmask) >> f->Rshift) * alpha) << f->Rshift)
+                   | (div255(((p & f->Gmask) >> f->Gshift) * alpha) << f->Gshift)
+                   | (div255(((p & f->Bmask) >> f->Bshift) * alpha) << f->Bshift)
+                   | (p & f->Amask);
+        }
+    }
+    SDL_UnlockSurface(surface);
+}
+
+void AlphaBlend::blit(SDL_Surface* src, const SDL_Rect* srcRect, SDL_Surface* dst, SDL_Rect* dstRect) {
+    if (!src || !dst) {
+        return;
+    }
+
+    const SDL_PixelFormat* sf = src->format;
+    const SDL_PixelFormat* df = dst->format;
+    if (sf->BytesPerPixel != 4 || !sf->Amask || df->BytesPerPixel < 2) {
+        // Not something this blends, leave it to SDL
+        SDL_BlitSurface(src, const_cast<SDL_Rect*>(srcRect), dst, dstRect);
+        return;
+    }
+
+    int srcX = srcRect ? srcRect->x : 0;
+    int srcY = srcRect ? srcRect->y : 0;
+    int width = srcRect ? std::min<int>(srcRect->w, src->w - srcX) : src->w;
+    int height = srcRect ? std::min<int>(srcRect->h, src->h - srcY) : src->h;
+    int x = dstRect ? dstRect->x : 0;
+    int y = dstRect ? dstRect->y : 0;
+
+    bool visible = clip(dst, x, y, width, height, srcX, srcY);
+    if (dstRect) {
+        dstRect->x = x;
+        dstRect->y = y;
+        dstRect->w = visible ? width : 0;
+        dstRect->h = visible ? height : 0;
+    }
+    if (!visible) {
+        return;
+    }
+
+    bool fast = df->BytesPerPixel == 4 && sf->Amask == 0xff000000
+        && sf->Rmask == df->Rmask && sf->Gmask == df->Gmask && sf->Bmask == df->Bmask;
+
+    SDL_LockSurface(src);
+    SDL_LockSurface(dst);
+    for (int row = 0; row < height; row++) {
+        const Uint8* s = static_cast<const Uint8*>(src->pixels) + (srcY + row) * src->pitch + srcX * 4;
+        Uint8* d = static_cast<Uint8*>(dst->pixels) + (y + row) * dst->pitch + x * df->BytesPerPixel;
+
+        if (fast) {
+            blendRow32(reinterpret_cast<const Uint32*>(s), reinterpret_cast<Uint32*>(d), width);
+            continue;
+        }
+
+        for (int i = 0; i < width; i++) {
+            Uint32 p = reinterpret_cast<const Uint32*>(s)[i];
+            unsigned alpha = (p & sf->Amask) >> sf->Ashift;
+            if (alpha == 0) {
+                continue;
+            }
+            blendPixel(d + i * df->BytesPerPixel, df,
+                       (p & sf->Rmask) >> sf->Rshift, (p & sf->Gmask) >> sf->Gshift,
+                       (p & sf->Bmask) >> sf->Bshift, 255 - alpha);
+        }
+    }
+    SDL_UnlockSurface(dst);
+    SDL_UnlockSurface(src);
+}
+
+void AlphaBlend::fillRect(SDL_Surface* dst, const SDL_Rect* rect, SDL_Color color, Uint8 alpha) {
+    if (!dst || alpha == 0 || dst->format->BytesPerPixel < 2) {
+        return;
+    }
+
+    int x = rect ? rect->x : dst->clip_rect.x;
+    int y = rect ? rect->y : dst->clip_rect.y;
+    int width = rect ? rect->w : dst->clip_rect.w;
+    int height = rect ? rect->h : dst->clip_rect.h;
+    int srcX = 0, srcY = 0;
+    if (!clip(dst, x, y, width, height, srcX, srcY)) {
+        return;
+    }
+
+    const SDL_PixelFormat* df = dst->format;
+    unsigned r = div255(color.r * alpha);
+    unsigned g = div255(color.g * alpha);
+    unsigned b = div255(color.b * alpha);
+    unsigned inv = 255 - alpha;
+
+    SDL_LockSurface(dst);
+    for (int row = 0; row < height; row++) {
+        Uint8* d = static_cast<Uint8*>(dst->pixels) + (y + row) * dst->pitch + x * df->BytesPerPixel;
+
+        if (df->BytesPerPixel == 4 && df->Rloss == 0 && df->Gloss == 0 && df->Bloss == 0) {
+            Uint32 packed = (r << df->Rshift) | (g << df->Gshift) | (b << df->Bshift);
+            fillRow32(reinterpret_cast<Uint32*>(d), width, packed, inv);
+            continue;
+        }
+
+        for (int i = 0; i < width; i++) {
+            blendPixel(d + i * df->BytesPerPixel, df, r, g, b, inv);
+        }
+    }
+    SDL_UnlockSurface(dst);
+}
@@ -8,6 +8,8 @@
 #include <iostream>
 #include <algorithm>
 #include <fstream>
+#include <chrono>
+#include <ctime>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ini_parser.hpp>
@@ -20,15 +22,17 @@
 
 
 Application::Application() 
-    : i18n("/userdata/system/configs/simplermenu_plus/i18n.ini"),
-      cfg("/userdata/system/configs/simplermenu_plus/config.ini", 
+    : cfg("/userdata/system/configs/simplermenu_plus/config.ini", 
           "/userdata/system/configs/simplermenu_plus/.state"),
-      theme(cfg.get(Configuration::HOME_PATH), cfg.get(Configuration::THEME_PATH), cfg.get(Configuration::THEME), cfg.getInt(Configuration::SCREEN_WIDTH), cfg.getInt(Configuration::SCREEN_HEIGHT)),
-      controlMapping(cfg),
-      renderComponent(cfg, theme),
+      theme(cfg.get(Configuration::Key::HOME_PATH), cfg.get(Configuration::Key::THEME_PATH), cfg.get(Configuration::Key::THEME), cfg.getInt(Configuration::Key::SCREEN_WIDTH), cfg.getInt(Configuration::Key::SCREEN_HEIGHT)),
+      i18n("/userdata/system/configs/simplermenu_plus/i18n.ini"),
+      systems(cfg.get(Configuration::Key::HOME_PATH) + "section_groups/",
+              cfg.get(Configuration::Key::HOME_PATH) + "systems.json"),
       appSettings(cfg, i18n, 0, 100, 5),
-      systemSettings(cfg, i18n, 0, 100, 5),
-      romSettings(cfg, i18n, 0, 100, 5)
+      systemSettings(cfg, i18n, systems, 0, 100, 5),
+      romSettings(cfg, i18n, systems, 0, 100, 5),
+      controlMapping(cfg),
+      renderComponent(cfg, theme)
  {
 
     // Observe settings changes
@@ -38,6 +42,7 @@ Application::Application()
 
     // Language observers
     attach(&romSettings);
+    attach(&renderComponent);
 
     romSettings.initializeSettings();
     systemSettings.initializeSettings();
@@ -93,7 +98,7 @@ Application::Application()
 
     populateMenu(menu);
 
-    theme.loadTheme(cfg.get(Configuration::HOME_PATH), cfg.get(Configuration::THEME_PATH), cfg.get(Configuration::THEME), cfg.getInt(Configuration::SCREEN_WIDTH), cfg.getInt(Configuration::SCREEN_HEIGHT));
+    theme.loadTheme(cfg.get(Configuration::Key::HOME_PATH), cfg.get(Configuration::Key::THEME_PATH), cfg.get(Configuration::Key::THEME), cfg.getInt(Configuration::Key::SCREEN_WIDTH), cfg.getInt(Configuration::Key::SCREEN_HEIGHT));
 
     renderComponent.initialize();
 
@@ -102,6 +107,11 @@ Application::Application()
         std::cerr << "Failed to initialize SDL joystick subsystem: " << SDL_GetError() << std::endl;
     }
 
+    // Timers end the main loop's wait for input at the next frame
+    if (SDL_InitSubSystem(SDL_INIT_TIMER) < 0) {
+        std::cerr << "Failed to initialize SDL timer subsystem: " << SDL_GetError() << std::endl;
+    }
+
     if (SDL_NumJoysticks() > 0) {
         joystick = SDL_JoystickOpen(0);
         if (!joystick) {
@@ -121,27 +131,34 @@ void Application::drawCurrentState() {
     switch (state.currentMenuLevel) {
         case MENU_SECTION:
         {
-            std::string sectionName = menu.getSections()[state.currentSectionIndex].getTitle();
+            std::string sectionName(menu.getSections()[state.currentSectionIndex].getTitle());
 
             int numberOfFolders = menu.getSections()[state.currentSectionIndex].getFolders().size();
+
+            const MenuRange<Section> sections = menu.getSections();
+            int count = sections.size();
+            renderComponent.prefetchSections(sections[(state.currentSectionIndex + count - 1) % count].getTitle(),
+                                             sections[(state.currentSectionIndex + 1) % count].getTitle());
             renderComponent.drawSection(sectionName, numberOfFolders);
             break;
         }
         case MENU_FOLDER:
         {
-            std::string folderName = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getTitle();
+            std::string folderName(menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getTitle());
             std::string folderPath = "";
             int numberOfRoms = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getRoms().size();
+
+            const MenuRange<Folder> folders = menu.getSections()[state.currentSectionIndex].getFolders();
+            int count = folders.size();
+            renderComponent.prefetchFolders(folders[(state.currentFolderIndex + count - 1) % count].getTitle(),
+                                            folders[(state.currentFolderIndex + 1) % count].getTitle());
             renderComponent.drawFolder(folderName, folderPath, numberOfRoms);
             break;
         }
         case MENU_ROM:
         {
-            std::vector<std::pair<std::string, std::string>> romData;
-            for (const Rom& rom : menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getRoms()) {
-                romData.push_back({rom.getTitle(), rom.getPath()});
-            }
-            renderComponent.drawRomList(menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getTitle(), romData, state.currentRomIndex);
+            // The renderer reads the visible page straight from the menu
+            renderComponent.drawRomList(menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex], state.currentRomIndex);
             break;
         }
         case APP_SETTINGS:
@@ -183,17 +200,18 @@ void Application::handleCommand(ControlMap cmd) {
                 state.currentMenuLevel = MenuLevel::MENU_ROM;
                 state.currentRomIndex = 0;
                 renderComponent.resetValues();
-                romSettings.getCores(menu.getSections()[state.currentSectionIndex].getTitle(), menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getTitle() );
+                const Section section = menu.getSections()[state.currentSectionIndex];
+                romSettings.getCores(std::string(section.getTitle()), std::string(section.getFolders()[state.currentFolderIndex].getTitle()));
             } else if (cmd == CMD_BACK) { // KEY_B/ESC
                 state.currentMenuLevel = MenuLevel::MENU_SECTION;
                 renderComponent.resetValues();
             } else if (cmd == CMD_UP) { // UP
-                const Section& section = menu.getSections()[state.currentSectionIndex];
+                const Section section = menu.getSections()[state.currentSectionIndex];
                 if (state.currentFolderIndex > 0) state.currentFolderIndex--;
                 else state.currentFolderIndex = section.getFolders().size() - 1;
                 //folderSettings.getCores(menu.getSections()[state.currentSectionIndex].getTitle(), menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getTitle() );
             } else if (cmd == CMD_DOWN) { // DOWN
-                const Section& section = menu.getSections()[state.currentSectionIndex];
+                const Section section = menu.getSections()[state.currentSectionIndex];
                 state.currentFolderIndex = (state.currentFolderIndex + 1) % section.getFolders().size();
                 //folderSettings.getCores(menu.getSections()[state.currentSectionIndex].getTitle(), menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getTitle() );
             } else if (cmd == CMD_ROM_SETTINGS) {
@@ -213,11 +231,11 @@ void Application::handleCommand(ControlMap cmd) {
                 state.currentMenuLevel = MenuLevel::MENU_FOLDER;
                 renderComponent.resetValues();
             } else if (cmd == CMD_UP) { // UP
-                const Folder& folder = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex];
+                const Folder folder = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex];
                 if (state.currentRomIndex > 0) state.currentRomIndex--;
                 else state.currentRomIndex = folder.getRoms().size() - 1;
             } else if (cmd == CMD_DOWN) { // DOWN
-                const Folder& folder = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex];
+                const Folder folder = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex];
                 state.currentRomIndex = (state.currentRomIndex + 1) % folder.getRoms().size();
             } else if (cmd == CMD_ENTER) { // ENTER
                 std::cout << "execute rom" << std::endl;
@@ -339,70 +357,140 @@ bool Application::isInteger(const std::string &s) {
     return !s.empty() && std::find_if(s.begin(), s.end(), [](unsigned char c) { return !std::isdigit(c); }) == s.end();
 }
 
+Uint32 Application::pushDeadlineEvent(Uint32, void*) {
+    SDL_Event event = {};
+    event.type = SDL_USEREVENT;
+    event.user.code = DEADLINE_EVENT;
+    SDL_PushEvent(&event);
+    return 0;
+}
+
+bool Application::waitEvent(SDL_Event& event, Uint32 deadline) {
+    if (SDL_PollEvent(&event)) {
+        return true;
+    }
+    Sint32 remaining = static_cast<Sint32>(deadline - SDL_GetTicks());
+    if (remaining <= 0) {
+        return false;
+    }
+
+    // SDL 1.2 has no SDL_WaitEventTimeout, a one-shot timer posts an event
+    // at the deadline to end the wait instead
+    SDL_TimerID timer = SDL_AddTimer(remaining, pushDeadlineEvent, nullptr);
+    if (!timer) {
+        // No timer subsystem, sleep between short polls
+        while (!SDL_PollEvent(&event)) {
+            remaining = static_cast<Sint32>(deadline - SDL_GetTicks());
+            if (remaining <= 0) {
+                return false;
+            }
+            SDL_Delay(std::min<Uint32>(remaining, INPUT_POLL_INTERVAL));
+        }
+        return true;
+    }
+
+    bool received = SDL_WaitEvent(&event)
+        && !(event.type == SDL_USEREVENT && event.user.code == DEADLINE_EVENT);
+    SDL_RemoveTimer(timer);
+    return received;
+}
+
 void Application::run() {
     bool isRunning = true;
     SDL_Event event;
 
     int fps = 0;
     int frameCount = 0;
-    Uint32 fpsTimer = 0;
+    Uint32 fpsTimer = SDL_GetTicks();
 
-    Uint32 frameStart = 0;
+    // Process CPU time, to report the load next to the FPS counter
+    int cpuLoad = 0;
+    std::clock_t cpuTimer = std::clock();
 
-    while (isRunning) {
-        int screenRefresh = cfg.getInt(Configuration::SCREEN_REFRESH);
-        
-        Uint32 frameDelay = 1000 / screenRefresh;
+    // Text and glyphs rasterized, steady frames should not rasterize any
+    int textMisses = 0;
+    std::uint64_t textMissCount = 0;
 
-        // Wait if last frame was drawn too fast
-        if (SDL_GetTicks() - frameStart < frameDelay) {
-            continue;
-        }
+    // Refresh rates are read once per run
+    const Uint32 frameDelay = 1000 / std::max(1, cfg.getInt(Configuration::Key::SCREEN_REFRESH));
+    const Uint32 idleDelay = 1000 / std::max(1, cfg.getInt(Configuration::Key::IDLE_REFRESH, 1));
 
-        // // Fine tune FPS
-        if (frameCount == screenRefresh && ((SDL_GetTicks() - fpsTimer) < 1000)) {
-            continue;
+    Uint32 lastFrame = SDL_GetTicks() - frameDelay;
+    bool redraw = true;
+
+    while (isRunning) {
+        // Sleep until the next frame is due. Input, animations and held
+        // buttons redraw at the screen refresh rate, an idle menu only at
+        // the idle rate
+        bool active = redraw || isButtonHeld || renderComponent.isAnimating();
+        Uint32 delay = active ? frameDelay : idleDelay;
+
+        if (waitEvent(event, lastFrame + delay)) {
+            do {
+                switch (event.type) {
+                    case SDL_QUIT:
+                        isRunning = false;
+                        break;
+                    case SDL_KEYDOWN:
+                    case SDL_JOYAXISMOTION:
+                    case SDL_JOYBUTTONDOWN:
+                    case SDL_JOYHATMOTION:
+                        isButtonHeld = true;
+                        lastHeldEvent = event;
+                        repeatStartTime = SDL_GetTicks() + 500;
+                        repeatInterval = 100;
+                        handleCommand(controlMapping.convertCommand(event));
+                        redraw = true;
+                        break;
+                    case SDL_JOYBUTTONUP:
+                    case SDL_KEYUP:
+                        isButtonHeld = false;
+                        break;
+                }
+            } while (SDL_PollEvent(&event));
         }
 
-        frameStart = SDL_GetTicks();
-
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_QUIT:
-                    isRunning = false;
-                    break;
-                case SDL_KEYDOWN:
-                case SDL_JOYAXISMOTION:
-                case SDL_JOYBUTTONDOWN:
-                case SDL_JOYHATMOTION:
-                    isButtonHeld = true;
-                    lastHeldEvent = event;
-                    repeatStartTime = SDL_GetTicks() + 500;
-                    repeatInterval = 100;
-                    handleCommand(controlMapping.convertCommand(event));
-                    break;
-                case SDL_JOYBUTTONUP:
-                case SDL_KEYUP:
-                    isButtonHeld = false;
-                    break;
-            }
+        // Input wakes the loop early. It is handled right away, but repeats
+        // and drawing wait until the frame is due, so a steady stream of
+        // events such as stick jitter cannot hold off the next frame
+        Uint32 now = SDL_GetTicks();
+        active = redraw || isButtonHeld || renderComponent.isAnimating();
+        if (!isRunning || now - lastFrame < (active ? frameDelay : idleDelay)) {
+            continue;
         }
 
-        if (isButtonHeld && SDL_GetTicks() > repeatStartTime) {
+        if (isButtonHeld && now > repeatStartTime) {
             handleCommand(controlMapping.convertCommand(lastHeldEvent));
-            repeatStartTime = SDL_GetTicks() + repeatInterval;
+            repeatStartTime = now + repeatInterval;
+            // A repeat moves the selection like a press, repaint it
+            redraw = true;
         }
 
         // Handle FPS information
-        if (SDL_GetTicks() - fpsTimer >= 1000) {
-            fps = frameCount;
+        if (now - fpsTimer >= 1000) {
+            std::clock_t cpuTime = std::clock();
+            cpuLoad = 100.0 * (cpuTime - cpuTimer) / CLOCKS_PER_SEC * 1000 / (now - fpsTimer);
+            cpuTimer = cpuTime;
+
+            std::uint64_t misses = renderComponent.getTextCache().getMisses()
+                                 + renderComponent.getGlyphAtlas().getMisses();
+            textMisses = misses - textMissCount;
+            textMissCount = misses;
+
+            fps = frameCount * 1000 / (now - fpsTimer);
             frameCount = 0;
-            fpsTimer = SDL_GetTicks();
+            fpsTimer = now;
+        }
+
+        lastFrame = now;
+        if (redraw) {
+            renderComponent.invalidate();
+            redraw = false;
         }
 
         drawCurrentState();
 
-        renderComponent.printFPS(fps);
+        renderComponent.printFPS(fps, cpuLoad, textMisses);
 
         renderComponent.update();
 
@@ -428,31 +516,28 @@ void Application::launchRom() {
     state.launcherCallback = true;
     cfg.saveState(state);
 
-    std::string romName = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getRoms()[state.currentRomIndex].getTitle();
-    std::string romPath = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getRoms()[state.currentRomIndex].getPath();
-    std::string folderName = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getTitle();
-    std::string sectionName = menu.getSections()[state.currentSectionIndex].getTitle();
-    std::cout << "Launching rom: " << sectionName << " -> " << folderName << " -> " << romName << std::endl;
+    const Section section = menu.getSections()[state.currentSectionIndex];
+    const Folder folder = section.getFolders()[state.currentFolderIndex];
+    const Rom rom = folder.getRoms()[state.currentRomIndex];
 
-    std::map<std::string, ConsoleData> consoleDataMap = cfg.parseIniFile(cfg.get(Configuration::HOME_PATH) + "section_groups/" + sectionName);
-
-    std::string corePath = "";
+    std::string romName(rom.getTitle());
+    std::string romPath(rom.getPath());
+    std::string folderName(folder.getTitle());
+    std::string sectionName(section.getTitle());
+    std::cout << "Launching rom: " << sectionName << " -> " << folderName << " -> " << romName << std::endl;
 
-    for (const auto& item : menuCache.loadFromCache(cfg.get(Configuration::HOME_PATH) + "/" + cfg.get(Configuration::GLOBAL_CACHE))) {
-        if (item.path == romPath) {
-            corePath = item.core;
-        }
-    }
+    // The menu and the cache share the catalog, the core is read in place
+    std::string corePath(rom.getCore());
     if (corePath == "" || corePath == "default") {
         std::cout << "corePath: " << corePath << std::endl;
-        corePath = cfg.get(Configuration::CORE_OVERRIDE);
+        corePath = cfg.get(Configuration::Key::CORE_OVERRIDE);
         std::cout << "corePath: " << corePath << std::endl;
 
     }
 
     // We are using the last selected core for a given system, by default it's the first available core only another 
     // core has been selected in rom settings -> core override
-    std::string execLauncher = cfg.get(Configuration::HOME_PATH) + "launchers/" + corePath;
+    std::string execLauncher = cfg.get(Configuration::Key::HOME_PATH) + "launchers/" + corePath;
 
     // Launch emulator
     std::string command = execLauncher + " '" + romPath + "'";
@@ -486,15 +571,19 @@ void Application::settingsChanged(const std::string& key, const std::string& val
         notifyLanguageChange();
 
     } else if (key == Configuration::THEME) {
-        theme.loadTheme(cfg.get(Configuration::HOME_PATH), cfg.get(Configuration::THEME_PATH), value, cfg.getInt(Configuration::SCREEN_WIDTH), cfg.getInt(Configuration::SCREEN_HEIGHT));
+        theme.loadTheme(cfg.get(Configuration::Key::HOME_PATH), cfg.get(Configuration::Key::THEME_PATH), value, cfg.getInt(Configuration::Key::SCREEN_WIDTH), cfg.getInt(Configuration::Key::SCREEN_HEIGHT));
+
+        // Fonts of the previous theme are not needed anymore
+        FontRegistry::getInstance().clear();
+        renderComponent.themeChanged();
     } else if (key == Configuration::CORE_OVERRIDE) {
         std::cout << "Calling CORE OVERRIDE " << std::endl;
         
         if (state.currentMenuLevel == ROM_SETTINGS) {
-            std::string romPath = menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getRoms()[state.currentRomIndex].getPath();
+            std::string romPath(menu.getSections()[state.currentSectionIndex].getFolders()[state.currentFolderIndex].getRoms()[state.currentRomIndex].getPath());
 
             if (romPath != "") {
-                menuCache.updateCacheItem(cfg.get(Configuration::HOME_PATH) + "/" + cfg.get(Configuration::GLOBAL_CACHE), romPath, value);
+                menuCache.updateCacheItem(getCacheFilePath(), romPath, value);
             }
         }
     } 
@@ -547,17 +636,31 @@ std::string Application::getName() {
 /////////////////
 // Private methods
 
+std::string Application::getCacheFilePath() {
+    return cfg.get(Configuration::Key::HOME_PATH) + "/" 
+        + cfg.get(Configuration::Key::GLOBAL_CATALOG, "caches/global_cache.bin");
+}
+
 void Application::loadCache(bool force) {
-   
-    // Initialize menu cache field
-    MenuCache menuCache;
 
     // Get the path to the cache file from config.ini file
-    std::string cacheFilePath = cfg.get(Configuration::HOME_PATH) + "/" + cfg.get(Configuration::GLOBAL_CACHE);
+    std::string cacheFilePath = getCacheFilePath();
+    std::string jsonFilePath = cfg.get(Configuration::Key::HOME_PATH) + "/" + cfg.get(Configuration::Key::GLOBAL_CACHE);
+
+    if (!menuCache.cacheExists(cacheFilePath) && menuCache.cacheExists(jsonFilePath)) {
+        // Migrate a JSON cache left by a previous version, so its core
+        // overrides and directory stamps are kept
+        std::vector<CachedMenuItem> items;
+        std::vector<CachedDirectory> directories;
+        if (menuCache.importFromJSON(jsonFilePath, items, directories)) {
+            std::cout << "Migrating JSON cache " << jsonFilePath << std::endl;
+            menuCache.saveToCache(cacheFilePath, items, directories);
+        }
+    }
 
-    if (force || !menuCache.cacheExists(cacheFilePath)) {
+    if (force || !menuCache.loadFromCache(cacheFilePath).isOpen()) {
         // Cache does not exist or force update is requested:
-        // Read all sections and create a new cache
+        // Read all sections and refresh the cache
 
         std::cout << "Force cache update" << std::endl;
         
@@ -568,78 +671,182 @@ void Application::loadCache(bool force) {
         // create the directories if they do not exist
         std::filesystem::create_directories(cacheFilePathObj.string());
 
-        menuCache.saveToCache(cacheFilePath, populateCache());
+        // Start from the previous cache, if any, so that only the rom
+        // directories modified since the last scan are enumerated again
+        std::vector<CachedDirectory> directories;
+        bool changed = false;
+        std::vector<CachedMenuItem> items = 
+            populateCache(menuCache.loadFromCache(cacheFilePath), directories, changed);
+
+        if (changed) {
+            menuCache.saveToCache(cacheFilePath, items, directories);
+        } else {
+            std::cout << "Rom directories unchanged, keeping cache file" << std::endl;
+        }
 
     } else {
 
         std::cout << "Cache exists, loading from cache file" << std::endl;
-        // Ignore the return value as we are not using it here, just
-        // load the cache file contents into the in-memory cache
-        menuCache.loadFromCache(cacheFilePath);
 
     }
 
+    if (cfg.getBool(Configuration::Key::EXPORT_CACHE_JSON, false)) {
+        std::cout << "Exporting cache to " << jsonFilePath << std::endl;
+        menuCache.exportToJSON(jsonFilePath);
+    }
+
 }
 
-std::vector<CachedMenuItem> Application::populateCache() {
+std::vector<CachedMenuItem> Application::populateCache(
+        const Catalog& previous,
+        std::vector<CachedDirectory>& directories,
+        bool& changed) {
 
     FileManager fileManager(cfg);
 
-    std::string sectGroupsPath = cfg.get(Configuration::HOME_PATH) 
-        + "section_groups/";
+    // Section groups edited since startup are read again
+    systems.refresh();
 
-    // Load section groups from the section_groups folder
-    auto sectionGroups = fileManager.getFiles(sectGroupsPath);
+    std::string romsPath = cfg.get(Configuration::Key::ROMS_PATH);
 
-    std::string romsPath = cfg.get(Configuration::ROMS_PATH);
+    // Collect every rom directory first, in section/console/romDir order,
+    // so the scanner can spread them across its workers
+    std::vector<ScanJob> jobs;
 
-    std::vector<CachedMenuItem> allCachedItems;
+    for (const SectionGroup& group : systems.getSections()) {
+        for (const SystemInfo& system : group.systems) {
+            for (const auto& romDir : system.romDirs) {
+                jobs.push_back({group.file, system.name, romsPath + romDir});
+            }
+        }
+    }
 
-    for (const auto& sectionGroupFile : sectionGroups) {
+    // Locate every directory of the previous scan within the previous items.
+    // Items of a directory are stored contiguously, in directory order
+    auto directoryKey = [](const std::string& section, const std::string& folder,
+                           const std::string& path) {
+        return section + "\n" + folder + "\n" + path;
+    };
+
+    std::vector<CachedDirectory> previousDirectories;
+    previousDirectories.reserve(previous.getDirectoryCount());
+    for (std::size_t i = 0; i < previous.getDirectoryCount(); i++) {
+        previousDirectories.push_back(previous.getDirectory(i));
+    }
 
-        auto consoleDataMap = cfg.parseIniFile(
-            sectGroupsPath + sectionGroupFile);
+    std::unordered_map<std::string, std::size_t> previousIndex;
+    std::vector<std::size_t> previousOffsets;
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < previousDirectories.size(); i++) {
+        const CachedDirectory& dir = previousDirectories[i];
+        previousIndex[directoryKey(dir.section, dir.folder, dir.path)] = i;
+        previousOffsets.push_back(offset);
+        offset += dir.entries;
+    }
+    if (offset != previous.size()) {
+        // Stamps don't describe the items, don't trust any of them
+        previousIndex.clear();
+    }
 
-        for (const auto& [consoleName, data] : consoleDataMap) {
+    std::vector<std::size_t> previousDirOf(jobs.size(), SIZE_MAX);
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        auto it = previousIndex.find(directoryKey(jobs[i].section, jobs[i].folder, jobs[i].directory));
+        if (it != previousIndex.end()) {
+            previousDirOf[i] = it->second;
+            jobs[i].knownMtime = previousDirectories[it->second].mtime;
+        }
+    }
 
-            for (const auto& romDir : data.romDirs) {
+    // Anything added, removed or reordered in section_groups changes the cache
+    changed = jobs.size() != previousDirectories.size();
 
-                auto files = fileManager.getFiles(romsPath + romDir);
-                for (const auto& file : files) {
-                    std::string romPath = romsPath + romDir + file;
-                    allCachedItems.push_back({sectionGroupFile, consoleName, file, romPath});
+    // Zero or less picks one worker per core
+    RomScanner scanner(fileManager, std::max(0, cfg.getInt(Configuration::Key::SCAN_THREADS, 0)));
+
+    std::cout << "Scanning " << jobs.size() << " rom directories using "
+              << scanner.getThreadCount(jobs.size()) << " threads" << std::endl;
+
+    auto scanStart = std::chrono::steady_clock::now();
+    std::vector<ScanResult> results = scanner.scan(jobs);
+
+    std::vector<CachedMenuItem> allCachedItems;
+    directories.clear();
+    directories.reserve(jobs.size());
+
+    // Directories modified this close to the scan may still change within
+    // the filesystem timestamp granularity, so they are never trusted
+    std::int64_t racyLimit = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - 2000000000LL;
+
+    // Merge back in job order, reporting the time spent on each console
+    unsigned int consoleMs = 0;
+    std::size_t consoleRoms = 0;
+    std::size_t rescanned = 0;
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        const ScanJob& job = jobs[i];
+        const ScanResult& result = results[i];
+        std::size_t firstItem = allCachedItems.size();
+
+        if (previousDirOf[i] != i) {
+            changed = true;
+        }
+
+        if (result.unchanged) {
+            // Splice the items of the previous scan back in
+            std::size_t first = previousOffsets[previousDirOf[i]];
+            std::size_t last = first + previousDirectories[previousDirOf[i]].entries;
+            for (std::size_t item = first; item < last; item++) {
+                allCachedItems.push_back(previous.getItem(item));
+            }
+        } else {
+            // Keep the cores chosen for roms that were already there
+            std::unordered_map<std::string, std::string> previousCores;
+            if (previousDirOf[i] != SIZE_MAX) {
+                std::size_t first = previousOffsets[previousDirOf[i]];
+                std::size_t last = first + previousDirectories[previousDirOf[i]].entries;
+                for (std::size_t item = first; item < last; item++) {
+                    previousCores[previous.getPath(item)] = previous.getCore(item);
                 }
+            }
 
+            for (const auto& file : result.files) {
+                std::string romPath = job.directory + file;
+                auto core = previousCores.find(romPath);
+                allCachedItems.push_back({job.section, job.folder, file, romPath,
+                    core != previousCores.end() ? core->second : "default"});
             }
+            changed = true;
+            rescanned++;
+        }
+
+        std::size_t entries = allCachedItems.size() - firstItem;
+        directories.push_back({job.section, job.folder, job.directory,
+                               result.mtime > racyLimit ? -1 : result.mtime, entries});
+
+        consoleMs += result.elapsedMs;
+        consoleRoms += entries;
+
+        bool lastOfConsole = i + 1 == jobs.size()
+            || jobs[i + 1].section != job.section
+            || jobs[i + 1].folder != job.folder;
+        if (lastOfConsole) {
+            std::cout << "Scanned " << job.section << " -> " << job.folder << ": "
+                      << consoleRoms << " roms in " << consoleMs << " ms" << std::endl;
+            consoleMs = 0;
+            consoleRoms = 0;
         }
     }
 
+    std::cout << "Rescanned " << rescanned << " of " << jobs.size() << " directories, "
+              << allCachedItems.size() << " roms in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - scanStart).count()
+              << " ms" << std::endl;
+
     return allCachedItems;
 }
 
 void Application::populateMenu(Menu& menu) {
-    // Loop through the cached items and populate the Menu structure
-    for (const auto& cachedItem : menuCache.loadFromCache(cfg.get(Configuration::HOME_PATH) + "/" + cfg.get(Configuration::GLOBAL_CACHE))) {
-        // cachedItem should have members: section, system, filename, path.
-
-        // Check if the section already exists in the menu
-        Section* section = menu.getSectionByName(cachedItem.section);
-        if (!section) {
-            Section newSection(cachedItem.section);
-            menu.addSection(newSection);
-            section = menu.getSectionByName(cachedItem.section);
-        }
-
-        // Check if the Folder already exists in the section
-        Folder* folder = section->getFolderByName(cachedItem.folder);
-        if (!folder) {
-            Folder newFolder(cachedItem.folder);
-            section->addFolder(newFolder);
-            folder = section->getFolderByName(cachedItem.folder);
-        }
-
-        // Add the file to the folder
-        Rom rom(cachedItem.rom, cachedItem.path);
-        folder->addRom(rom);
-    }
-}
\ No newline at end of file
+    // The menu reads its strings from the mapped catalog, nothing is copied
+    menu.build(menuCache.loadFromCache(getCacheFilePath()));
+}
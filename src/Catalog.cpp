@@ -0,0 +1,178 @@
+#include "Catalog.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// The file is mapped and read in place, so the records must keep this layout
+static_assert(sizeof(CatalogHeader) == 32, "unexpected CatalogHeader layout");
+static_assert(sizeof(CatalogDirectory) == 24, "unexpected CatalogDirectory layout");
+static_assert(sizeof(CatalogItem) == 20, "unexpected CatalogItem layout");
+
+const char Catalog::MAGIC[4] = {'S', 'M', 'P', 'C'};
+const std::uint32_t Catalog::VERSION = 1;
+const CatalogItem Catalog::EMPTY_ITEM = {};
+const CatalogDirectory Catalog::EMPTY_DIRECTORY = {};
+
+Catalog::~Catalog() {
+    close();
+}
+
+bool Catalog::open(const std::string& filePath) {
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(CatalogHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    // Validated in a catalog of its own, the current one stays mapped until
+    // the new file is known to be good
+    Catalog next;
+    next.mapping = data;
+    next.mappingSize = st.st_size;
+
+    const CatalogHeader* h = static_cast<const CatalogHeader*>(data);
+    const char* base = static_cast<const char*>(data);
+
+    // Reject anything written by another version or pointing outside the
+    // file. Sizes are computed in 64 bits, counts from a corrupt header
+    // would wrap a 32 bit size_t
+    std::uint64_t itemsOffset = static_cast<std::uint64_t>(h->directoriesOffset)
+        + static_cast<std::uint64_t>(h->directoryCount) * sizeof(CatalogDirectory);
+    std::uint64_t stringsOffset = static_cast<std::uint64_t>(h->itemsOffset)
+        + static_cast<std::uint64_t>(h->itemCount) * sizeof(CatalogItem);
+    bool valid = std::memcmp(h->magic, MAGIC, sizeof(MAGIC)) == 0
+        && h->version == VERSION
+        && h->directoriesOffset == sizeof(CatalogHeader)
+        && h->itemsOffset == itemsOffset
+        && h->stringsOffset == stringsOffset
+        && static_cast<std::uint64_t>(h->stringsOffset) + h->stringTableSize == next.mappingSize
+        && h->stringTableSize > 0
+        && base[next.mappingSize - 1] == '\0';
+
+    if (!valid) {
+        std::cerr << "Invalid catalog file: " << filePath << std::endl;
+        return false;
+    }
+
+    next.header = h;
+    next.directories = reinterpret_cast<const CatalogDirectory*>(base + h->directoriesOffset);
+    next.items = reinterpret_cast<const CatalogItem*>(base + h->itemsOffset);
+    next.strings = base + h->stringsOffset;
+
+    swap(next);
+    return true;
+}
+
+void Catalog::swap(Catalog& other) noexcept {
+    std::swap(mapping, other.mapping);
+    std::swap(mappingSize, other.mappingSize);
+    std::swap(header, other.header);
+    std::swap(directories, other.directories);
+    std::swap(items, other.items);
+    std::swap(strings, other.strings);
+}
+
+void Catalog::close() {
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    directories = nullptr;
+    items = nullptr;
+    strings = nullptr;
+}
+
+CachedMenuItem Catalog::getItem(std::size_t index) const {
+    return {getSection(index), getFolder(index), getRom(index), getPath(index), getCore(index)};
+}
+
+CachedDirectory Catalog::getDirectory(std::size_t index) const {
+    const CatalogDirectory& dir = index < getDirectoryCount() ? directories[index] : EMPTY_DIRECTORY;
+    return {getString(dir.section), getString(dir.folder), getString(dir.path), dir.mtime, dir.entries};
+}
+
+bool Catalog::write(const std::string& filePath,
+                    const std::vector<CachedMenuItem>& data,
+                    const std::vector<CachedDirectory>& directories) {
+
+    // Sections, folders and cores repeat for almost every item, so every
+    // distinct string is only stored once. Offset 0 is the empty string
+    std::string stringTable(1, '\0');
+    std::unordered_map<std::string, std::uint32_t> stringOffsets;
+    stringOffsets[""] = 0;
+
+    auto intern = [&](const std::string& value) {
+        auto it = stringOffsets.find(value);
+        if (it != stringOffsets.end()) {
+            return it->second;
+        }
+        std::uint32_t offset = stringTable.size();
+        stringTable.append(value.c_str(), value.size() + 1);
+        stringOffsets.emplace(value, offset);
+        return offset;
+    };
+
+    std::vector<CatalogDirectory> dirRecords;
+    dirRecords.reserve(directories.size());
+    for (const auto& dir : directories) {
+        dirRecords.push_back({intern(dir.section), intern(dir.folder), intern(dir.path),
+                              static_cast<std::uint32_t>(dir.entries), dir.mtime});
+    }
+
+    std::vector<CatalogItem> itemRecords;
+    itemRecords.reserve(data.size());
+    for (const auto& item : data) {
+        itemRecords.push_back({intern(item.section), intern(item.folder), intern(item.rom),
+                               intern(item.path), intern(item.core.empty() ? "default" : item.core)});
+    }
+
+    CatalogHeader h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.directoryCount = dirRecords.size();
+    h.itemCount = itemRecords.size();
+    h.stringTableSize = stringTable.size();
+    h.directoriesOffset = sizeof(CatalogHeader);
+    h.itemsOffset = h.directoriesOffset + dirRecords.size() * sizeof(CatalogDirectory);
+    h.stringsOffset = h.itemsOffset + itemRecords.size() * sizeof(CatalogItem);
+
+    std::string tmpPath = filePath + ".tmp";
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "Unable to write catalog file: " << tmpPath << std::endl;
+        return false;
+    }
+
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1
+        && fwrite(dirRecords.data(), sizeof(CatalogDirectory), dirRecords.size(), fp) == dirRecords.size()
+        && fwrite(itemRecords.data(), sizeof(CatalogItem), itemRecords.size(), fp) == itemRecords.size()
+        && fwrite(stringTable.data(), 1, stringTable.size(), fp) == stringTable.size();
+    ok = fclose(fp) == 0 && ok;
+
+    if (!ok || rename(tmpPath.c_str(), filePath.c_str()) != 0) {
+        std::cerr << "Unable to write catalog file: " << filePath << std::endl;
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
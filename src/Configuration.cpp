@@ -4,6 +4,9 @@
 #include <boost/property_tree/ini_parser.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/algorithm/string.hpp>
+#include <sstream>
+
+#include "IniFile.h"
 
 
 /////////
@@ -25,6 +28,16 @@ const std::string Configuration::SCREEN_WIDTH = std::string("GLOBAL.screenWidth"
 const std::string Configuration::SCREEN_HEIGHT = std::string("GLOBAL.screenHeight");
 const std::string Configuration::SCREEN_DEPTH = std::string("GLOBAL.screenDepth");
 const std::string Configuration::GLOBAL_CACHE = std::string("GLOBAL.globalCacheJSON");
+const std::string Configuration::GLOBAL_CATALOG = std::string("GLOBAL.globalCatalog");
+const std::string Configuration::EXPORT_CACHE_JSON = std::string("GLOBAL.exportCacheJSON");
+const std::string Configuration::SCAN_THREADS = std::string("GLOBAL.scanThreads");
+const std::string Configuration::TEXT_CACHE_KB = std::string("GLOBAL.textCacheKB");
+const std::string Configuration::THUMBNAIL_CACHE_KB = std::string("GLOBAL.thumbnailCacheKB");
+const std::string Configuration::BACKGROUND_CACHE_KB = std::string("GLOBAL.backgroundCacheKB");
+const std::string Configuration::THUMBNAIL_DISK_CACHE = std::string("GLOBAL.thumbnailDiskCache");
+const std::string Configuration::THUMBNAIL_DISK_CACHE_MB = std::string("GLOBAL.thumbnailDiskCacheMB");
+const std::string Configuration::THUMBNAIL_PREFETCH_AHEAD = std::string("GLOBAL.thumbnailPrefetchAhead");
+const std::string Configuration::THUMBNAIL_PREFETCH_BEHIND = std::string("GLOBAL.thumbnailPrefetchBehind");
 
 
 // CONFIG . APPLICATION section
@@ -32,6 +45,7 @@ const std::string Configuration::VOLUME = std::string("APPLICATION.volume");
 const std::string Configuration::BRIGHTNESS = std::string("APPLICATION.brightness");
 const std::string Configuration::SCREEN_REFRESH = std::string("APPLICATION.screenRefresh");
 const std::string Configuration::SHOW_FPS = std::string("APPLICATION.showFPS");
+const std::string Configuration::IDLE_REFRESH = std::string("APPLICATION.idleRefresh");
 const std::string Configuration::OVERCLOCK = std::string("APPLICATION.overclock");
 const std::string Configuration::OVERCLOCK_VALUES = std::string("GLOBAL.overclockValues");
 const std::string Configuration::THEME = std::string("APPLICATION.theme");
@@ -54,6 +68,55 @@ const std::string Configuration::ROM_OVERCLOCK = std::string("GAME.romOverclock"
 const std::string Configuration::ROM_AUTOSTART = std::string("GAME.romAutostart");
 const std::string Configuration::CORE_OVERRIDE = std::string("GAME.coreOverride");
 
+// Ids of the typed keys, in Key order
+const std::string* const Configuration::KEY_IDS[] = {
+    // GLOBAL
+    &Configuration::ALIAS_PATH,
+    &Configuration::HOME_PATH,
+    &Configuration::THEME_PATH,
+    &Configuration::ROMS_PATH,
+    &Configuration::IMAGES_PATH,
+    &Configuration::SCREEN_WIDTH,
+    &Configuration::SCREEN_HEIGHT,
+    &Configuration::SCREEN_DEPTH,
+    &Configuration::GLOBAL_CACHE,
+    &Configuration::GLOBAL_CATALOG,
+    &Configuration::EXPORT_CACHE_JSON,
+    &Configuration::SCAN_THREADS,
+    &Configuration::TEXT_CACHE_KB,
+    &Configuration::THUMBNAIL_CACHE_KB,
+    &Configuration::BACKGROUND_CACHE_KB,
+    &Configuration::THUMBNAIL_DISK_CACHE,
+    &Configuration::THUMBNAIL_DISK_CACHE_MB,
+    &Configuration::THUMBNAIL_PREFETCH_AHEAD,
+    &Configuration::THUMBNAIL_PREFETCH_BEHIND,
+    &Configuration::OVERCLOCK_VALUES,
+    &Configuration::THUMBNAIL_TYPE_VALUES,
+    &Configuration::USB_MODE_VALUES,
+    // APPLICATION
+    &Configuration::VOLUME,
+    &Configuration::BRIGHTNESS,
+    &Configuration::SCREEN_REFRESH,
+    &Configuration::SHOW_FPS,
+    &Configuration::IDLE_REFRESH,
+    &Configuration::OVERCLOCK,
+    &Configuration::THEME,
+    &Configuration::THUMBNAIL_TYPE,
+    &Configuration::USB_MODE,
+    &Configuration::WIFI,
+    &Configuration::ROTATION,
+    &Configuration::LANGUAGE,
+    &Configuration::UPDATE_CACHES,
+    &Configuration::RESTART,
+    &Configuration::QUIT,
+    // SYSTEM
+    &Configuration::CORE_SELECTION,
+    // GAME
+    &Configuration::ROM_OVERCLOCK,
+    &Configuration::ROM_AUTOSTART,
+    &Configuration::CORE_OVERRIDE,
+};
+
 
 /////////
 // THEME.INI
@@ -119,12 +182,89 @@ Configuration::Configuration(const std::string& configIniFilepath,
                              const std::string& stateFilepath) 
     : configIniFilepath(configIniFilepath), stateFilepath(stateFilepath) {
 
-    // Load values from .ini file using Boost.PropertyTree
-    boost::property_tree::ini_parser::read_ini(configIniFilepath, mainPt);
+    // The tree is kept for the settings menus and saveConfigIni, built in
+    // file order as read_ini would
+    IniFile iniFile(configIniFilepath);
+    auto addEntries = [](boost::property_tree::ptree& container, const IniFile::Section& section) {
+        for (const IniFile::Entry* entry = section.begin; entry != section.end; ++entry) {
+            container.push_back(std::make_pair(std::string(entry->key),
+                                               boost::property_tree::ptree(std::string(entry->value))));
+        }
+    };
+    addEntries(mainPt, iniFile.getTopLevel());
+    for (const auto& section : iniFile.getSections()) {
+        addEntries(mainPt.push_back(std::make_pair(std::string(section.name),
+                                                   boost::property_tree::ptree()))->second, section);
+    }
+
+    static_assert(sizeof(KEY_IDS) / sizeof(KEY_IDS[0]) == static_cast<std::size_t>(Key::COUNT),
+                  "KEY_IDS must list every Configuration::Key");
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        refresh(static_cast<Key>(i));
+    }
+}
+
+void Configuration::refresh(Key key) {
+    // Same conversions as ptree::get<int> and ptree::get<bool>
+    Slot& s = slots[static_cast<std::size_t>(key)];
+    s = Slot();
+    auto value = mainPt.get_optional<std::string>(getId(key));
+    if (!value) {
+        return;
+    }
+    s.text = *value;
+    s.present = true;
+
+    std::istringstream intStream(s.text);
+    intStream >> s.intValue;
+    if (!intStream.fail() && !intStream.eof()) {
+        intStream >> std::ws;
+    }
+    s.isInt = !intStream.fail() && intStream.eof();
+
+    if (s.text == "true" || s.text == "1") {
+        s.boolValue = s.isBool = true;
+    } else if (s.text == "false" || s.text == "0") {
+        s.boolValue = false;
+        s.isBool = true;
+    }
+}
+
+bool Configuration::findKey(const std::string& id, Key& key) {
+    static const std::unordered_map<std::string, Key> keysById = [] {
+        std::unordered_map<std::string, Key> map;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(Key::COUNT); ++i) {
+            map.emplace(*KEY_IDS[i], static_cast<Key>(i));
+        }
+        return map;
+    }();
+
+    auto it = keysById.find(id);
+    if (it == keysById.end()) {
+        return false;
+    }
+    key = it->second;
+    return true;
+}
+
+void Configuration::throwBadKey(Key key, const char* type) {
+    // What ptree would have thrown for the string lookup
+    throw boost::property_tree::ptree_bad_data(
+        "Missing value or conversion to " + std::string(type) + " failed for " + getId(key), getId(key));
 }
 
 void Configuration::set(const std::string& id, const std::string& value) {
     mainPt.put(id, value);
+
+    Key key;
+    if (findKey(id, key)) {
+        refresh(key);
+    }
+}
+
+void Configuration::set(Key key, const std::string& value) {
+    mainPt.put(getId(key), value);
+    refresh(key);
 }
 
 std::string Configuration::get(const std::string& id) const {
@@ -132,6 +272,11 @@ std::string Configuration::get(const std::string& id) const {
     return mainPt.get<std::string>(id);
 }
 
+std::string Configuration::get(const std::string& id, const std::string& defaultValue) const {
+    // Used for optional keys that older config.ini files may not have
+    return mainPt.get<std::string>(id, defaultValue);
+}
+
 bool Configuration::getBool(const std::string& id) const {
     // TODO exceptions  ptree_bad_path, ptree_bad_data, both from ptree_error
     return mainPt.get<bool>(id);
@@ -145,6 +290,10 @@ bool Configuration::getBool(const std::string& id) const {
     // }
 }
 
+bool Configuration::getBool(const std::string& id, bool defaultValue) const {
+    return mainPt.get<bool>(id, defaultValue);
+}
+
 int Configuration::getInt(const std::string& id) const {
     // TODO exceptions  ptree_bad_path, ptree_bad_data, both from ptree_error
     return mainPt.get<int>(id);
@@ -157,6 +306,11 @@ int Configuration::getInt(const std::string& id) const {
     // }
 }
 
+int Configuration::getInt(const std::string& id, int defaultValue) const {
+    // Used for optional keys that older config.ini files may not have
+    return mainPt.get<int>(id, defaultValue);
+}
+
 std::set<std::string> Configuration::getList(const std::string& id, 
                                              const char delimiter) const {
     std::set<std::string> result;
@@ -178,58 +332,15 @@ std::string Configuration::getThemePath() const {
 
     // TODO Do we really need to convert to int and then again to string?
     std::string themePath = 
-        get(Configuration::HOME_PATH) +
-        get(Configuration::THEME_PATH) +
-        std::to_string(getInt(Configuration::SCREEN_WIDTH)) + "x" +
-        std::to_string(getInt(Configuration::SCREEN_HEIGHT)) + "/" + 
-        get(Configuration::THEME) + "/";
+        get(Key::HOME_PATH) +
+        get(Key::THEME_PATH) +
+        std::to_string(getInt(Key::SCREEN_WIDTH)) + "x" +
+        std::to_string(getInt(Key::SCREEN_HEIGHT)) + "/" + 
+        get(Key::THEME) + "/";
         
     return themePath;
 }
 
-std::map<std::string, ConsoleData> Configuration::parseIniFile(const std::string& iniPath) {
-    boost::property_tree::ptree pt;
-    boost::property_tree::read_ini(iniPath, pt);
-
-    std::map<std::string, ConsoleData> consoleDataMap;
-    auto consoleList = pt.get<std::string>(Configuration::CONSOLES_LIST);
-    std::stringstream ss(consoleList);
-    std::string consoleName;
-
-    while (std::getline(ss, consoleName, ',')) {
-        ConsoleData data;
-        data.name = consoleName;
-        
-        std::string execs_str = pt.get<std::string>(
-            consoleName + Configuration::CONSOLE_EXECS);
-        std::stringstream ss(execs_str);
-        std::string exec;
-        while (std::getline(ss, exec, ',')) {
-            data.execs.push_back(exec);
-        }
-
-        std::string romExts_str = pt.get<std::string>(
-            consoleName + Configuration::CONSOLE_ROM_EXTS);
-        ss = std::stringstream(romExts_str);
-        std::string romExt;
-        while (std::getline(ss, romExt, ',')) {
-            data.romExts.push_back(romExt);
-        }
-
-        std::string romDirs_str = pt.get<std::string>(
-            consoleName + Configuration::CONSOLE_ROM_DIRS);
-        ss = std::stringstream(romDirs_str);
-        std::string romDir;
-        while (std::getline(ss, romDir, ',')) {
-            data.romDirs.push_back(romDir);
-        }
-
-        consoleDataMap[consoleName] = data;
-    }
-
-    return consoleDataMap;
-}
-
 void Configuration::saveConfigIni() {
     
     boost::property_tree::ini_parser::write_ini(configIniFilepath, mainPt);
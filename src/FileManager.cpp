@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <iostream>
 #include <algorithm>
+#include <sys/stat.h>
 
 std::vector<std::string> FileManager::getFolders(const std::string& path) {
     std::vector<std::string> folders;
@@ -25,8 +26,6 @@ std::vector<std::string> FileManager::getFolders(const std::string& path) {
 // Retrieve a list of files from a given folder
 std::vector<std::string> FileManager::getFiles(const std::string& folder) {
     std::vector<std::string> files;
-    std::set<std::string> excludedExtensions = 
-        cfg.getList("GLOBAL.excludedExtensions");
 
     try {
         for (const auto& entry : std::filesystem::directory_iterator(folder)) {
@@ -52,4 +51,10 @@ std::vector<std::string> FileManager::getFiles(const std::string& folder) {
     return files;
 }
 
-
+std::int64_t FileManager::getModificationTime(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return 0;
+    }
+    return static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
@@ -0,0 +1,43 @@
+#include "FontRegistry.h"
+#include <iostream>
+
+FontRegistry& FontRegistry::getInstance() {
+    static FontRegistry instance;
+    return instance;
+}
+
+FontRegistry::~FontRegistry() {
+    // Fonts can only be closed while SDL_ttf is still initialized
+    if (TTF_WasInit()) {
+        clear();
+    }
+}
+
+TTF_Font* FontRegistry::getFont(const std::string& path, int size, int hinting, int style) {
+    FontKey key{path, size, hinting, style};
+    auto it = fonts.find(key);
+    if (it != fonts.end()) {
+        return it->second;
+    }
+
+    TTF_Font* font = TTF_OpenFont(path.c_str(), size);
+    if (font) {
+        TTF_SetFontHinting(font, hinting);
+        TTF_SetFontStyle(font, style);
+        TTF_SetFontKerning(font, 1);
+    } else {
+        std::cerr << "Failed to load font " << path << ": " << TTF_GetError() << std::endl;
+    }
+
+    fonts.emplace(std::move(key), font);
+    return font;
+}
+
+void FontRegistry::clear() {
+    for (auto& entry : fonts) {
+        if (entry.second) {
+            TTF_CloseFont(entry.second);
+        }
+    }
+    fonts.clear();
+}
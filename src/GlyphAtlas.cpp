@@ -0,0 +1,218 @@
+#include "GlyphAtlas.h"
+#include "AlphaBlend.h"
+#include <algorithm>
+
+GlyphAtlas::~GlyphAtlas() {
+    clear();
+}
+
+void GlyphAtlas::decode(const std::string& text) {
+    codepoints.clear();
+
+    const unsigned char* s = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = s + text.size();
+
+    while (s < end) {
+        std::uint32_t ch = *s++;
+        int extra = 0;
+
+        if (ch >= 0xF0) { ch &= 0x07; extra = 3; }
+        else if (ch >= 0xE0) { ch &= 0x0F; extra = 2; }
+        else if (ch >= 0xC0) { ch &= 0x1F; extra = 1; }
+        else if (ch >= 0x80) { ch = 0xFFFD; }  // Stray continuation byte
+
+        for (; extra > 0; extra--) {
+            if (s == end || (*s & 0xC0) != 0x80) {
+                ch = 0xFFFD;
+                break;
+            }
+            ch = (ch << 6) | (*s++ & 0x3F);
+        }
+
+        // SDL_ttf glyph functions take UCS-2 code points
+        codepoints.push_back(ch > 0xFFFF ? 0xFFFD : static_cast<Uint16>(ch));
+    }
+}
+
+GlyphAtlas::FontData& GlyphAtlas::getFontData(TTF_Font* font) {
+    auto it = fonts.find(font);
+    if (it == fonts.end()) {
+        it = fonts.emplace(font, FontData()).first;
+        it->second.ascent = TTF_FontAscent(font);
+    }
+    return it->second;
+}
+
+const GlyphAtlas::Metrics& GlyphAtlas::getMetrics(TTF_Font* font, FontData& data, Uint16 ch) {
+    auto it = data.metrics.find(ch);
+    if (it != data.metrics.end()) {
+        return it->second;
+    }
+
+    Metrics m = {0, 0, 0, 0};
+    int miny = 0;
+    if (TTF_GlyphMetrics(font, ch, &m.minx, &m.maxx, &miny, &m.maxy, &m.advance) != 0) {
+        m = {0, 0, 0, 0};
+    }
+    return data.metrics.emplace(ch, m).first->second;
+}
+
+int GlyphAtlas::getKerning(TTF_Font* font, FontData& data, Uint16 left, Uint16 right) {
+    std::uint32_t pair = (static_cast<std::uint32_t>(left) << 16) | right;
+    auto it = data.kerning.find(pair);
+    if (it != data.kerning.end()) {
+        return it->second;
+    }
+
+    // SDL_ttf 2.0 has no kerning pair query. Measure the pair and take out
+    // the width the two glyphs would have without kerning, computed the same
+    // way TTF_SizeUNICODE does
+    const Metrics& a = getMetrics(font, data, left);
+    const Metrics& b = getMetrics(font, data, right);
+
+    int kerning = 0;
+    Uint16 text[3] = {left, right, 0};
+    int w = 0;
+    if (TTF_SizeUNICODE(font, text, &w, nullptr) == 0) {
+        int minx = std::min({0, a.minx, a.advance + b.minx});
+        int maxx = std::max({0, std::max(a.advance, a.maxx),
+                             a.advance + std::max(b.advance, b.maxx)});
+        kerning = w - (maxx - minx);
+    }
+
+    data.kerning.emplace(pair, kerning);
+    return kerning;
+}
+
+const GlyphAtlas::Glyph* GlyphAtlas::getGlyph(TTF_Font* font, Pages& atlas, Uint16 ch, SDL_Color color) {
+    auto it = atlas.glyphs.find(ch);
+    if (it != atlas.glyphs.end()) {
+        return it->second.rect.w > 0 ? &it->second : nullptr;
+    }
+
+    misses++;
+
+    Glyph glyph = {-1, {0, 0, 0, 0}};
+    SDL_Surface* surface = TTF_RenderGlyph_Blended(font, ch, color);
+
+    if (surface && surface->w > 0 && surface->h > 0
+        && surface->w <= atlas.pageSize && surface->h <= atlas.pageSize) {
+
+        // Next shelf, then next page when the glyph doesn't fit
+        if (atlas.shelfX + surface->w > atlas.pageSize) {
+            atlas.shelfX = 0;
+            atlas.shelfY += atlas.shelfHeight;
+            atlas.shelfHeight = 0;
+        }
+        if (atlas.pages.empty() || atlas.shelfY + surface->h > atlas.pageSize) {
+            SDL_PixelFormat* fmt = surface->format;
+            SDL_Surface* page = SDL_CreateRGBSurface(SDL_SWSURFACE, atlas.pageSize, atlas.pageSize, 32,
+                                                     fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+            if (page) {
+                SDL_FillRect(page, nullptr, 0);
+                atlas.pages.push_back(page);
+                bytes += static_cast<std::size_t>(page->pitch) * page->h;
+            }
+            atlas.shelfX = 0;
+            atlas.shelfY = 0;
+            atlas.shelfHeight = 0;
+        }
+
+        if (!atlas.pages.empty()) {
+            glyph.page = atlas.pages.size() - 1;
+            glyph.rect = {static_cast<Sint16>(atlas.shelfX), static_cast<Sint16>(atlas.shelfY),
+                          static_cast<Uint16>(surface->w), static_cast<Uint16>(surface->h)};
+
+            // Without SDL_SRCALPHA the blit copies the alpha channel as is
+            SDL_SetAlpha(surface, 0, SDL_ALPHA_OPAQUE);
+            SDL_Rect dstRect = glyph.rect;
+            SDL_BlitSurface(surface, nullptr, atlas.pages[glyph.page], &dstRect);
+            AlphaBlend::premultiply(atlas.pages[glyph.page], &glyph.rect);
+
+            atlas.shelfX += surface->w;
+            atlas.shelfHeight = std::max<int>(atlas.shelfHeight, surface->h);
+            glyphCount++;
+        }
+    }
+
+    if (surface) {
+        SDL_FreeSurface(surface);
+    }
+
+    // Blank glyphs like spaces are stored with an empty rectangle
+    Glyph& stored = atlas.glyphs.emplace(ch, glyph).first->second;
+    return stored.rect.w > 0 ? &stored : nullptr;
+}
+
+int GlyphAtlas::getTextWidth(TTF_Font* font, const std::string& text) {
+    if (!font) {
+        return 0;
+    }
+
+    decode(text);
+    FontData& data = getFontData(font);
+
+    int x = 0;
+    int width = 0;
+    for (std::size_t i = 0; i < codepoints.size(); i++) {
+        if (i > 0) {
+            x += getKerning(font, data, codepoints[i - 1], codepoints[i]);
+        }
+        const Metrics& m = getMetrics(font, data, codepoints[i]);
+        width = std::max(width, x + std::max(m.advance, m.maxx));
+        x += m.advance;
+    }
+    return width;
+}
+
+int GlyphAtlas::drawText(SDL_Surface* dst, TTF_Font* font, const std::string& text,
+                         SDL_Color color, int x, int y) {
+    if (!font) {
+        return 0;
+    }
+
+    decode(text);
+    FontData& data = getFontData(font);
+
+    Uint32 packedColor = (color.r << 16) | (color.g << 8) | color.b;
+    auto it = atlases.find({font, packedColor});
+    if (it == atlases.end()) {
+        it = atlases.emplace(std::make_pair(font, packedColor), Pages()).first;
+        it->second.pageSize = std::max(PAGE_SIZE, TTF_FontHeight(font) * 4);
+    }
+    Pages& atlas = it->second;
+
+    int penX = x;
+    int width = 0;
+    for (std::size_t i = 0; i < codepoints.size(); i++) {
+        Uint16 ch = codepoints[i];
+        if (i > 0) {
+            penX += getKerning(font, data, codepoints[i - 1], ch);
+        }
+
+        const Metrics& m = getMetrics(font, data, ch);
+        const Glyph* glyph = getGlyph(font, atlas, ch, color);
+        if (glyph) {
+            SDL_Rect srcRect = glyph->rect;
+            SDL_Rect dstRect = {static_cast<Sint16>(penX + m.minx),
+                                static_cast<Sint16>(y + data.ascent - m.maxy), 0, 0};
+            AlphaBlend::blit(atlas.pages[glyph->page], &srcRect, dst, &dstRect);
+        }
+
+        width = std::max(width, penX - x + std::max(m.advance, m.maxx));
+        penX += m.advance;
+    }
+    return width;
+}
+
+void GlyphAtlas::clear() {
+    for (auto& entry : atlases) {
+        for (SDL_Surface* page : entry.second.pages) {
+            SDL_FreeSurface(page);
+        }
+    }
+    atlases.clear();
+    fonts.clear();
+    bytes = 0;
+    glyphCount = 0;
+}
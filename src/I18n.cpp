@@ -1,7 +1,7 @@
 #include "I18n.h"
 #include "Exception.h"
 #include <iostream>
-#include <boost/property_tree/ini_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
 #include <boost/algorithm/string.hpp>
 
 
@@ -15,14 +15,11 @@ const std::string I18n::ROM_SETTINGS = std::string("romSettings");
 
 
 I18n::I18n(const std::string& i18nFilepath) 
-    : i18nFilepath(i18nFilepath) {
-
-    // Load values from .ini file using Boost.PropertyTree
-    boost::property_tree::ini_parser::read_ini(i18nFilepath, mainPt);
+    : i18nFilepath(i18nFilepath), iniFile(i18nFilepath) {
 
     // Get languages list
-    for (const auto& section : this->mainPt) {
-        std::string normalizedLang = boost::algorithm::to_upper_copy(section.first);
+    for (const auto& section : iniFile.getSections()) {
+        std::string normalizedLang = boost::algorithm::to_upper_copy(std::string(section.name));
         languages.insert(normalizedLang);
     }
 
@@ -45,8 +42,12 @@ void I18n::setLang(const std::string& newLang) {
 }
 
 std::string I18n::get(const std::string& id) const {
-    // TODO exceptions  ptree_bad_path, ptree_bad_data, both from ptree_error 
-    return mainPt.get<std::string>(lang + "." + id);
+    // Missing texts throw ptree_bad_path, as the ptree lookup used to
+    std::string_view value;
+    if (!iniFile.find(lang, id, value)) {
+        throw boost::property_tree::ptree_bad_path("No such node", boost::property_tree::ptree::path_type(lang + "." + id));
+    }
+    return std::string(value);
 }
 
 std::set<std::string> I18n::getLanguages() const {
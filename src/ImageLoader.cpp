@@ -0,0 +1,134 @@
+#include "ImageLoader.h"
+#include <algorithm>
+#include <iostream>
+#include <sys/stat.h>
+#include <SDL/SDL_image.h>
+
+#include "ImageScaler.h"
+
+ImageLoader::ImageLoader() {
+    worker = std::thread(&ImageLoader::run, this);
+}
+
+ImageLoader::~ImageLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        pending.clear();
+    }
+    wake.notify_one();
+    worker.join();
+
+    for (ImageResult& result : finished) {
+        if (result.surface) {
+            SDL_FreeSurface(result.surface);
+        }
+    }
+}
+
+void ImageLoader::setStore(std::shared_ptr<const ThumbnailStore> store) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->store = std::move(store);
+}
+
+void ImageLoader::request(std::vector<ImageRequest> requests) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.assign(std::make_move_iterator(requests.begin()),
+                       std::make_move_iterator(requests.end()));
+    }
+    wake.notify_one();
+}
+
+bool ImageLoader::poll(ImageResult& result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (finished.empty()) {
+        return false;
+    }
+    result = std::move(finished.front());
+    finished.erase(finished.begin());
+    return true;
+}
+
+bool ImageLoader::isBusy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return busy || !pending.empty() || !finished.empty();
+}
+
+void ImageLoader::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        ImageRequest request = std::move(pending.front());
+        pending.pop_front();
+        busy = true;
+        std::shared_ptr<const ThumbnailStore> currentStore = store;
+
+        lock.unlock();
+        SDL_Surface* surface = load(request, currentStore.get());
+        lock.lock();
+
+        finished.push_back({std::move(request.path), surface});
+        busy = false;
+    }
+}
+
+SDL_Surface* ImageLoader::load(const ImageRequest& request, const ThumbnailStore* store) {
+    if (!store || !store->isEnabled()) {
+        return decode(request);
+    }
+
+    struct stat st;
+    if (stat(request.path.c_str(), &st) != 0) {
+        return nullptr;
+    }
+
+    // A warm thumbnail is read as it is, no inflate or resampling
+    SDL_Surface* surface = store->load(request.path, st.st_mtime, request.width, request.height);
+    if (surface) {
+        return surface;
+    }
+
+    // Store the pixels in the format they are displayed in
+    surface = decode(request, &store->getFormat());
+    if (surface) {
+        store->save(request.path, st.st_mtime, request.width, request.height, surface);
+    }
+
+    return surface;
+}
+
+SDL_Surface* ImageLoader::decode(const ImageRequest& request, const SDL_PixelFormat* format) {
+    struct stat st;
+    if (stat(request.path.c_str(), &st) != 0) {
+        return nullptr;
+    }
+
+    SDL_Surface* image = IMG_Load(request.path.c_str());
+    if (!image) {
+        std::cerr << "Failed to load image " << request.path << ": " << IMG_GetError() << std::endl;
+        return nullptr;
+    }
+
+    // Scale straight into the requested format
+    SDL_PixelFormat target = format ? *format : ImageScaler::getDefaultFormat();
+    SDL_Surface* result = nullptr;
+    if (request.width > 0 && request.height > 0
+        && (image->w != request.width || image->h != request.height)) {
+        result = ImageScaler::fit(image, request.width, request.height, target);
+        if (!result) {
+            std::cerr << "Failed to scale image: " << request.path << std::endl;
+        }
+    } else if (format) {
+        result = SDL_ConvertSurface(image, &target, SDL_SWSURFACE);
+    } else {
+        return image;
+    }
+
+    SDL_FreeSurface(image);
+    return result;
+}
@@ -0,0 +1,360 @@
+#include "ImageScaler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SCALER_NEON
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCALER_SSE2
+#endif
+
+namespace {
+
+// Horizontal weights add up to 256, so a filtered channel is 8.8 fixed
+// point and fits 16 bits. Vertical weights add up to 32768 and are applied
+// with a high multiply, which leaves 8.7 fixed point
+const int H_WEIGHT_ONE = 256;
+const int V_WEIGHT_ONE = 32768;
+
+// For each destination pixel, the source pixels it takes and their weights
+struct Taps {
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<std::uint16_t> weights;
+    std::vector<int> offsets;
+    int maxTaps = 0;
+
+    void build(int sourceSize, int targetSize, int one) {
+        double ratio = static_cast<double>(sourceSize) / targetSize;
+        std::vector<double> coverage;
+
+        for (int i = 0; i < targetSize; i++) {
+            int start;
+            coverage.clear();
+
+            if (ratio >= 2.0) {
+                // Box: every source pixel weighs what it covers
+                double from = i * ratio;
+                double to = std::min<double>((i + 1) * ratio, sourceSize);
+                start = static_cast<int>(from);
+                int end = std::min(sourceSize, static_cast<int>(std::ceil(to)));
+                for (int j = start; j < end; j++) {
+                    coverage.push_back((std::min<double>(to, j + 1) - std::max<double>(from, j)) / ratio);
+                }
+            } else {
+                // Bilinear between the two nearest pixel centers
+                double center = (i + 0.5) * ratio - 0.5;
+                start = static_cast<int>(std::floor(center));
+                double f = center - start;
+                if (start < 0) {
+                    start = 0;
+                    f = 0.0;
+                }
+                if (start >= sourceSize - 1) {
+                    start = sourceSize - 1;
+                    f = 0.0;
+                }
+                coverage.push_back(1.0 - f);
+                if (f > 0.0) {
+                    coverage.push_back(f);
+                }
+            }
+
+            // Round the weights, then give what rounding lost or added to
+            // the heaviest one so they always add up to exactly one
+            std::size_t base = weights.size();
+            std::size_t heaviest = base;
+            int sum = 0;
+            for (std::size_t k = 0; k < coverage.size(); k++) {
+                int w = static_cast<int>(coverage[k] * one + 0.5);
+                if (coverage[k] > coverage[heaviest - base]) {
+                    heaviest = base + k;
+                }
+                weights.push_back(w);
+                sum += w;
+            }
+            weights[heaviest] += one - sum;
+            offsets.push_back(base);
+
+            first.push_back(start);
+            count.push_back(coverage.size());
+            maxTaps = std::max<int>(maxTaps, coverage.size());
+        }
+    }
+};
+
+template <int BYTES>
+inline Uint32 readPixel(const Uint8* p) {
+    if (BYTES == 4) {
+        return *reinterpret_cast<const Uint32*>(p);
+    }
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    return p[0] | (p[1] << 8) | (p[2] << 16);
+#else
+    return (p[0] << 16) | (p[1] << 8) | p[2];
+#endif
+}
+
+// Filter one source row horizontally into 4 channels of 8.8 per pixel.
+// Channel k is byte k of the pixel value, whatever color it holds
+template <int BYTES>
+void filterRow(const Uint8* source, const Taps& taps, std::uint16_t* out, int width) {
+    for (int x = 0; x < width; x++) {
+        const Uint8* pixel = source + taps.first[x] * BYTES;
+        const std::uint16_t* weights = &taps.weights[taps.offsets[x]];
+        int count = taps.count[x];
+
+#if defined(SCALER_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i acc = zero;
+        for (int t = 0; t < count; t++) {
+            __m128i px = _mm_unpacklo_epi8(_mm_cvtsi32_si128(readPixel<BYTES>(pixel + t * BYTES)), zero);
+            acc = _mm_add_epi16(acc, _mm_mullo_epi16(px, _mm_set1_epi16(weights[t])));
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), acc);
+#elif defined(SCALER_NEON)
+        uint16x4_t acc = vdup_n_u16(0);
+        for (int t = 0; t < count; t++) {
+            uint16x4_t px = vget_low_u16(vmovl_u8(vcreate_u8(readPixel<BYTES>(pixel + t * BYTES))));
+            acc = vmla_n_u16(acc, px, weights[t]);
+        }
+        vst1_u16(out + x * 4, acc);
+#else
+        unsigned int acc[4] = {0, 0, 0, 0};
+        for (int t = 0; t < count; t++) {
+            Uint32 px = readPixel<BYTES>(pixel + t * BYTES);
+            for (int c = 0; c < 4; c++) {
+                acc[c] += ((px >> (c * 8)) & 0xff) * weights[t];
+            }
+        }
+        for (int c = 0; c < 4; c++) {
+            out[x * 4 + c] = acc[c];
+        }
+#endif
+    }
+}
+
+// Blend horizontally filtered rows into 8 bit channels
+void blendRows(const std::uint16_t* const* rows, const std::uint16_t* weights, int count,
+               Uint8* out, int lanes) {
+    int i = 0;
+
+#if defined(SCALER_SSE2)
+    const __m128i round = _mm_set1_epi16(64);
+    for (; i + 8 <= lanes; i += 8) {
+        __m128i acc = _mm_setzero_si128();
+        for (int t = 0; t < count; t++) {
+            __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[t] + i));
+            acc = _mm_add_epi16(acc, _mm_mulhi_epu16(row, _mm_set1_epi16(weights[t])));
+        }
+        acc = _mm_srli_epi16(_mm_add_epi16(acc, round), 7);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(acc, acc));
+    }
+#elif defined(SCALER_NEON)
+    const uint16x8_t round = vdupq_n_u16(64);
+    for (; i + 8 <= lanes; i += 8) {
+        uint16x8_t acc = vdupq_n_u16(0);
+        for (int t = 0; t < count; t++) {
+            uint16x8_t row = vld1q_u16(rows[t] + i);
+            uint16x4_t w = vdup_n_u16(weights[t]);
+            uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(row), w), 16);
+            uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(row), w), 16);
+            acc = vaddq_u16(acc, vcombine_u16(lo, hi));
+        }
+        vst1_u8(out + i, vqmovn_u16(vshrq_n_u16(vaddq_u16(acc, round), 7)));
+    }
+#endif
+
+    for (; i < lanes; i++) {
+        unsigned int acc = 0;
+        for (int t = 0; t < count; t++) {
+            acc += (static_cast<unsigned int>(rows[t][i]) * weights[t]) >> 16;
+        }
+        out[i] = std::min(255u, (acc + 64) >> 7);
+    }
+}
+
+int countBits(Uint32 mask) {
+    int bits = 0;
+    for (; mask; mask &= mask - 1) {
+        bits++;
+    }
+    return bits;
+}
+
+int lowestBit(Uint32 mask) {
+    int shift = 0;
+    while (mask && !(mask & 1)) {
+        mask >>= 1;
+        shift++;
+    }
+    return shift;
+}
+
+// Byte of the pixel value a channel lives in, -1 if it doesn't fill one
+int getChannelByte(Uint32 mask) {
+    int shift = lowestBit(mask);
+    return mask != 0 && shift % 8 == 0 && mask >> shift == 0xff ? shift / 8 : -1;
+}
+
+template <int BYTES>
+void scaleRows(SDL_Surface* source, SDL_Surface* target, const Taps& hTaps, const Taps& vTaps) {
+    const SDL_PixelFormat* sf = source->format;
+    const SDL_PixelFormat* tf = target->format;
+    int width = target->w;
+    int lanes = width * 4;
+
+    // Horizontally filtered rows, the taps of one target row are contiguous
+    // so a ring of maxTaps rows never hands out the same slot twice
+    int ringSize = vTaps.maxTaps;
+    std::vector<std::uint16_t> ring(static_cast<std::size_t>(ringSize) * lanes);
+    std::vector<int> ringRow(ringSize, -1);
+    std::vector<const std::uint16_t*> rows(ringSize);
+    std::vector<Uint8> channels(lanes);
+
+    int rByte = getChannelByte(sf->Rmask);
+    int gByte = getChannelByte(sf->Gmask);
+    int bByte = getChannelByte(sf->Bmask);
+    int aByte = getChannelByte(sf->Amask);
+
+    for (int y = 0; y < target->h; y++) {
+        int count = vTaps.count[y];
+        for (int t = 0; t < count; t++) {
+            int sourceRow = vTaps.first[y] + t;
+            int slot = sourceRow % ringSize;
+            std::uint16_t* row = &ring[static_cast<std::size_t>(slot) * lanes];
+            if (ringRow[slot] != sourceRow) {
+                const Uint8* pixels = static_cast<const Uint8*>(source->pixels) + sourceRow * source->pitch;
+                filterRow<BYTES>(pixels, hTaps, row, width);
+                ringRow[slot] = sourceRow;
+            }
+            rows[t] = row;
+        }
+
+        blendRows(rows.data(), &vTaps.weights[vTaps.offsets[y]], count, channels.data(), lanes);
+
+        // Pack into the target format
+        Uint8* out = static_cast<Uint8*>(target->pixels) + y * target->pitch;
+        for (int x = 0; x < width; x++) {
+            const Uint8* c = &channels[x * 4];
+            Uint32 pixel = ((c[rByte] >> tf->Rloss) << tf->Rshift)
+                         | ((c[gByte] >> tf->Gloss) << tf->Gshift)
+                         | ((c[bByte] >> tf->Bloss) << tf->Bshift);
+            if (tf->Amask) {
+                Uint8 alpha = aByte >= 0 ? c[aByte] : 255;
+                pixel |= (alpha >> tf->Aloss) << tf->Ashift;
+            }
+
+            switch (tf->BytesPerPixel) {
+                case 2:
+                    reinterpret_cast<Uint16*>(out)[x] = pixel;
+                    break;
+                case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+                    out[x * 3] = pixel;
+                    out[x * 3 + 1] = pixel >> 8;
+                    out[x * 3 + 2] = pixel >> 16;
+#else
+                    out[x * 3] = pixel >> 16;
+                    out[x * 3 + 1] = pixel >> 8;
+                    out[x * 3 + 2] = pixel;
+#endif
+                    break;
+                default:
+                    reinterpret_cast<Uint32*>(out)[x] = pixel;
+                    break;
+            }
+        }
+    }
+}
+
+}
+
+SDL_PixelFormat ImageScaler::makeFormat(int bitsPerPixel, Uint32 rmask, Uint32 gmask,
+                                        Uint32 bmask, Uint32 amask) {
+    SDL_PixelFormat format = {};
+    format.BitsPerPixel = bitsPerPixel;
+    format.BytesPerPixel = (bitsPerPixel + 7) / 8;
+    format.Rmask = rmask;
+    format.Gmask = gmask;
+    format.Bmask = bmask;
+    format.Amask = amask;
+    format.Rshift = lowestBit(rmask);
+    format.Gshift = lowestBit(gmask);
+    format.Bshift = lowestBit(bmask);
+    format.Ashift = lowestBit(amask);
+    format.Rloss = 8 - countBits(rmask);
+    format.Gloss = 8 - countBits(gmask);
+    format.Bloss = 8 - countBits(bmask);
+    format.Aloss = 8 - countBits(amask);
+    format.alpha = 255;
+    return format;
+}
+
+SDL_PixelFormat ImageScaler::getDefaultFormat() {
+    return makeFormat(32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+}
+
+SDL_Surface* ImageScaler::scale(SDL_Surface* source, int width, int height,
+                                const SDL_PixelFormat& format) {
+    if (!source || width <= 0 || height <= 0 || format.BitsPerPixel <= 8 || format.palette) {
+        return nullptr;
+    }
+
+    // Rows are read in place when every color fills a byte, anything else
+    // (palettes, 16 bpp) is expanded first
+    SDL_Surface* input = source;
+    const SDL_PixelFormat* sf = source->format;
+    bool direct = (sf->BytesPerPixel == 3 || sf->BytesPerPixel == 4) && !sf->palette
+        && getChannelByte(sf->Rmask) >= 0 && getChannelByte(sf->Gmask) >= 0
+        && getChannelByte(sf->Bmask) >= 0 && (sf->Amask == 0 || getChannelByte(sf->Amask) >= 0);
+    if (!direct) {
+        SDL_PixelFormat argb = getDefaultFormat();
+        input = SDL_ConvertSurface(source, &argb, SDL_SWSURFACE);
+        if (!input) {
+            return nullptr;
+        }
+    }
+
+    SDL_Surface* target = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, format.BitsPerPixel,
+                                               format.Rmask, format.Gmask, format.Bmask, format.Amask);
+    if (target) {
+        Taps hTaps, vTaps;
+        hTaps.build(input->w, width, H_WEIGHT_ONE);
+        vTaps.build(input->h, height, V_WEIGHT_ONE);
+
+        SDL_LockSurface(input);
+        SDL_LockSurface(target);
+        if (input->format->BytesPerPixel == 4) {
+            scaleRows<4>(input, target, hTaps, vTaps);
+        } else {
+            scaleRows<3>(input, target, hTaps, vTaps);
+        }
+        SDL_UnlockSurface(target);
+        SDL_UnlockSurface(input);
+    }
+
+    if (input != source) {
+        SDL_FreeSurface(input);
+    }
+    return target;
+}
+
+SDL_Surface* ImageScaler::fit(SDL_Surface* source, int boxWidth, int boxHeight,
+                              const SDL_PixelFormat& format) {
+    if (!source || source->w <= 0 || source->h <= 0) {
+        return nullptr;
+    }
+
+    double scaleX = static_cast<double>(boxWidth) / source->w;
+    double scaleY = static_cast<double>(boxHeight) / source->h;
+    double factor = std::min(scaleX, scaleY);
+
+    int width = std::max(1, static_cast<int>(source->w * factor + 0.5));
+    int height = std::max(1, static_cast<int>(source->h * factor + 0.5));
+    return scale(source, std::min(width, boxWidth), std::min(height, boxHeight), format);
+}
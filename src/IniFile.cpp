@@ -0,0 +1,208 @@
+#include "IniFile.h"
+#include <algorithm>
+#include <boost/property_tree/ini_parser.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && isSpace(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && isSpace(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+}
+
+IniFile::IniFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw boost::property_tree::ini_parser_error("cannot open file", path, 0);
+    }
+
+    struct stat st = {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const char*>(mapping);
+            size = st.st_size;
+        }
+    }
+    ::close(fd);
+
+    if (st.st_size > 0 && data == nullptr) {
+        throw boost::property_tree::ini_parser_error("read error", path, 0);
+    }
+
+    try {
+        parse(path);
+    } catch (...) {
+        if (data) {
+            ::munmap(const_cast<char*>(data), size);
+        }
+        throw;
+    }
+}
+
+IniFile::~IniFile() {
+    if (data) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+}
+
+void IniFile::parse(const std::string& path) {
+    // A UTF-8 BOM is not skipped, read_ini does not either
+    std::string_view text(data, size);
+
+    // Sections are collected as entry ranges first, the entry vector may
+    // still move while the file is read
+    struct Range {
+        std::string_view name;
+        std::size_t begin;
+        std::size_t end;
+    };
+    Range top = {std::string_view(), 0, 0};
+    std::vector<Range> ranges;
+
+    auto closeSection = [&]() {
+        if (ranges.empty()) {
+            top.end = entries.size();
+            return;
+        }
+        ranges.back().end = entries.size();
+        // Like read_ini, sections without keys are dropped
+        if (ranges.back().begin == ranges.back().end) {
+            ranges.pop_back();
+        }
+    };
+
+    unsigned long lineNo = 0;
+    while (!text.empty()) {
+        ++lineNo;
+        std::size_t eol = text.find('\n');
+        std::string_view line = trim(text.substr(0, eol));
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+
+        if (line.empty() || line[0] == ';' || line[0] == '#') {
+            continue;
+        }
+
+        if (line[0] == '[') {
+            std::size_t end = line.find(']');
+            if (end == std::string_view::npos) {
+                throw boost::property_tree::ini_parser_error("unmatched '['", path, lineNo);
+            }
+            closeSection();
+            // read_ini keeps sections and top level keys in one tree, a
+            // section may not reuse the name of either
+            std::string_view name = trim(line.substr(1, end - 1));
+            bool duplicate = std::any_of(ranges.begin(), ranges.end(), [name](const Range& range) {
+                return range.name == name;
+            }) || std::any_of(entries.begin() + top.begin, entries.begin() + top.end, [name](const Entry& entry) {
+                return entry.key == name;
+            });
+            if (duplicate) {
+                throw boost::property_tree::ini_parser_error("duplicate section name", path, lineNo);
+            }
+            ranges.push_back({name, entries.size(), entries.size()});
+            continue;
+        }
+
+        std::size_t eq = line.find('=');
+        if (eq == std::string_view::npos) {
+            throw boost::property_tree::ini_parser_error("'=' character not found in line", path, lineNo);
+        }
+        if (eq == 0) {
+            throw boost::property_tree::ini_parser_error("key expected", path, lineNo);
+        }
+        // Checked line by line so the first error is the one read_ini
+        // reports. Sections hold a few dozen keys, a scan is enough
+        std::string_view key = trim(line.substr(0, eq));
+        std::size_t sectionBegin = ranges.empty() ? top.begin : ranges.back().begin;
+        if (std::any_of(entries.begin() + sectionBegin, entries.end(), [key](const Entry& entry) {
+                return entry.key == key;
+            })) {
+            throw boost::property_tree::ini_parser_error("duplicate key name", path, lineNo);
+        }
+        entries.push_back({key, trim(line.substr(eq + 1))});
+    }
+    closeSection();
+
+    sortedEntries.resize(entries.size());
+    auto index = [&](const Range& range) {
+        auto first = sortedEntries.begin() + range.begin;
+        auto last = sortedEntries.begin() + range.end;
+        for (std::size_t i = range.begin; i < range.end; ++i) {
+            sortedEntries[i] = static_cast<std::uint32_t>(i);
+        }
+        std::sort(first, last, [this](std::uint32_t a, std::uint32_t b) {
+            return entries[a].key < entries[b].key;
+        });
+        return Section{range.name, entries.data() + range.begin, entries.data() + range.end};
+    };
+
+    topLevel = index(top);
+    sections.reserve(ranges.size());
+    for (const Range& range : ranges) {
+        sections.push_back(index(range));
+    }
+}
+
+const IniFile::Section* IniFile::findSection(std::string_view name) const {
+    // A handful of sections per file, a scan beats hashing
+    for (const Section& section : sections) {
+        if (section.name == name) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+bool IniFile::find(const Section& section, std::string_view key, std::string_view& value) const {
+    auto first = sortedEntries.begin() + (section.begin - entries.data());
+    auto last = sortedEntries.begin() + (section.end - entries.data());
+    auto it = std::lower_bound(first, last, key, [this](std::uint32_t index, std::string_view k) {
+        return entries[index].key < k;
+    });
+    if (it == last || entries[*it].key != key) {
+        return false;
+    }
+    value = entries[*it].value;
+    return true;
+}
+
+bool IniFile::find(std::string_view sectionName, std::string_view key, std::string_view& value) const {
+    const Section* section = findSection(sectionName);
+    return section && find(*section, key, value);
+}
+
+bool IniFile::find(std::string_view path, std::string_view& value) const {
+    std::size_t dot = path.find('.');
+    if (dot == std::string_view::npos) {
+        return find(topLevel, path, value);
+    }
+    return find(path.substr(0, dot), path.substr(dot + 1), value);
+}
+
+std::vector<std::string_view> IniFile::split(std::string_view value, char delimiter) {
+    std::vector<std::string_view> items;
+    while (!value.empty()) {
+        std::size_t end = value.find(delimiter);
+        items.push_back(value.substr(0, end));
+        if (end == std::string_view::npos) {
+            break;
+        }
+        value.remove_prefix(end + 1);
+    }
+    return items;
+}
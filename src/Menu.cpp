@@ -0,0 +1,61 @@
+#include "Menu.h"
+#include <unordered_map>
+
+void Menu::build(const Catalog& catalog) {
+    this->catalog = &catalog;
+    romItems.clear();
+    folders.clear();
+    sections.clear();
+
+    // First pass: group the catalog items by section and folder through hash
+    // indices keyed by the catalog strings, counting the roms of each folder
+    std::unordered_map<std::string_view, std::uint32_t> sectionIndex;
+    std::vector<std::unordered_map<std::string_view, std::uint32_t>> folderIndex;
+    std::vector<std::vector<std::uint32_t>> romCounts;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> itemSlots;
+    itemSlots.reserve(catalog.size());
+
+    for (std::size_t i = 0; i < catalog.size(); i++) {
+        auto [sectionIt, newSection] = 
+            sectionIndex.try_emplace(catalog.getSection(i), folderIndex.size());
+        std::uint32_t s = sectionIt->second;
+        if (newSection) {
+            folderIndex.emplace_back();
+            romCounts.emplace_back();
+        }
+
+        auto [folderIt, newFolder] = 
+            folderIndex[s].try_emplace(catalog.getFolder(i), romCounts[s].size());
+        std::uint32_t f = folderIt->second;
+        if (newFolder) {
+            romCounts[s].push_back(0);
+        }
+
+        romCounts[s][f]++;
+        itemSlots.emplace_back(s, f);
+    }
+
+    // Lay out the folder and section ranges, in the order they first
+    // appear in the catalog
+    sections.reserve(romCounts.size());
+    std::vector<std::uint32_t> firstFolder(romCounts.size());
+    std::uint32_t nextRom = 0;
+
+    for (std::size_t s = 0; s < romCounts.size(); s++) {
+        firstFolder[s] = folders.size();
+        sections.push_back({static_cast<std::uint32_t>(folders.size()),
+                            static_cast<std::uint32_t>(romCounts[s].size())});
+
+        for (std::uint32_t count : romCounts[s]) {
+            folders.push_back({nextRom, 0});
+            nextRom += count;
+        }
+    }
+
+    // Second pass: place every item in its folder range
+    romItems.resize(catalog.size());
+    for (std::size_t i = 0; i < catalog.size(); i++) {
+        FolderRange& folder = folders[firstFolder[itemSlots[i].first] + itemSlots[i].second];
+        romItems[folder.firstRom + folder.romCount++] = i;
+    }
+}
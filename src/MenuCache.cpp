@@ -1,81 +1,191 @@
 #include "MenuCache.h"
 #include <fstream>
 #include <iostream>
-#include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/prettywriter.h>
-#include <rapidjson/stringbuffer.h>
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/filewritestream.h>
+#include <rapidjson/reader.h>
 #include <cstdio>
+#include <chrono>
+#include <filesystem>
 
-void MenuCache::saveToCache(const std::string& filePath, const std::vector<CachedMenuItem>& data) {
-    rapidjson::Document doc;
-    doc.SetArray();
-    rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
+namespace {
 
-    for (const auto& item : data) {
-        rapidjson::Value obj(rapidjson::kObjectType);
-        obj.AddMember("section", rapidjson::Value(item.section.c_str(), allocator), allocator);
-        obj.AddMember("folder", rapidjson::Value(item.folder.c_str(), allocator), allocator);
-        obj.AddMember("rom", rapidjson::Value(item.rom.c_str(), allocator), allocator);
-        obj.AddMember("path", rapidjson::Value(item.path.c_str(), allocator), allocator);
-        obj.AddMember("core", rapidjson::Value("default", allocator), allocator);
-        doc.PushBack(obj, allocator);
+/**
+ * SAX handler that streams a JSON cache straight into items and directory
+ * stamps, without building a DOM first. It accepts both the current layout
+ * ({"directories": [...], "items": [...]}) and the first one, a plain
+ * array of items.
+ */
+class CacheJSONHandler 
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, CacheJSONHandler> {
+private:
+    enum Container { NONE, ITEMS, DIRECTORIES };
+
+    std::vector<CachedMenuItem>& data;
+    std::vector<CachedDirectory>& directories;
+
+    int depth = 0;
+    int recordDepth = 0;
+    Container container = NONE;
+    std::string key;
+
+    CachedMenuItem item;
+    CachedDirectory dir;
+
+    bool inRecord() const {
+        return container != NONE && depth == recordDepth;
     }
 
-    FILE* fp = fopen(filePath.c_str(), "w");
-    char writeBuffer[65536];
-    rapidjson::FileWriteStream os(fp, writeBuffer, sizeof(writeBuffer));
-    rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(os);
-    doc.Accept(writer);
-    fclose(fp);
+    bool setNumber(std::int64_t value) {
+        if (inRecord() && container == DIRECTORIES) {
+            if (key == "mtime") dir.mtime = value;
+            else if (key == "entries") dir.entries = value;
+        }
+        return true;
+    }
 
-    inMemoryCache[filePath] = data;
-}
+public:
+    CacheJSONHandler(std::vector<CachedMenuItem>& data, 
+                     std::vector<CachedDirectory>& directories)
+        : data(data), directories(directories) {}
 
-std::vector<CachedMenuItem> MenuCache::loadFromCache(const std::string& filePath) {
-    auto it = inMemoryCache.find(filePath);
-    if (it != inMemoryCache.end()) {
-        return it->second;
+    bool StartArray() {
+        depth++;
+        if (depth == 1) {
+            container = ITEMS;
+            recordDepth = 2;
+        } else if (depth == 2) {
+            container = key == "items" ? ITEMS 
+                      : key == "directories" ? DIRECTORIES : NONE;
+            recordDepth = 3;
+        }
+        return true;
     }
 
-    std::vector<CachedMenuItem> data;
-    FILE* fp = fopen(filePath.c_str(), "r");
-    if (!fp) return data;
-    char readBuffer[65536];
-    rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
-    rapidjson::Document doc;
-    doc.ParseStream(is);
-    fclose(fp);
+    bool EndArray(rapidjson::SizeType) {
+        if (depth == recordDepth - 1) {
+            container = NONE;
+        }
+        depth--;
+        return true;
+    }
+
+    bool StartObject() {
+        depth++;
+        if (inRecord()) {
+            item = CachedMenuItem();
+            dir = CachedDirectory();
+        }
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType) {
+        if (inRecord()) {
+            if (container == ITEMS) {
+                data.push_back(std::move(item));
+            } else {
+                directories.push_back(std::move(dir));
+            }
+        }
+        depth--;
+        return true;
+    }
+
+    bool Key(const char* str, rapidjson::SizeType length, bool) {
+        key.assign(str, length);
+        return true;
+    }
 
-    if (doc.IsArray()) {
-        for (auto& v : doc.GetArray()) {
-            CachedMenuItem item;
-            item.section = v["section"].GetString();
-            item.folder  = v["folder"].GetString();
-            item.rom     = v["rom"].GetString();
-            item.path    = v["path"].GetString();
-            item.core    = v["core"].GetString();
-            data.push_back(item);
+    bool String(const char* str, rapidjson::SizeType length, bool) {
+        if (!inRecord()) {
+            return true;
         }
+
+        std::string* field = nullptr;
+        if (container == ITEMS) {
+            if (key == "section") field = &item.section;
+            else if (key == "folder") field = &item.folder;
+            else if (key == "rom") field = &item.rom;
+            else if (key == "path") field = &item.path;
+            else if (key == "core") field = &item.core;
+        } else {
+            if (key == "section") field = &dir.section;
+            else if (key == "folder") field = &dir.folder;
+            else if (key == "path") field = &dir.path;
+        }
+
+        if (field) {
+            field->assign(str, length);
+        }
+        return true;
+    }
+
+    bool Int(int value) { return setNumber(value); }
+    bool Uint(unsigned value) { return setNumber(value); }
+    bool Int64(int64_t value) { return setNumber(value); }
+    bool Uint64(uint64_t value) { return setNumber(value); }
+};
+
+}
+
+bool MenuCache::saveToCache(const std::string& filePath, const std::vector<CachedMenuItem>& data,
+                            const std::vector<CachedDirectory>& directories) {
+    if (Catalog::write(filePath, data, directories)) {
+        // The new file replaced the old one, map it again
+        catalogPath.clear();
+        loadFromCache(filePath);
+        return true;
     }
 
-    inMemoryCache[filePath] = data;
-    return data;
+    // Read-only or full card: keep the scanned data for this run rather
+    // than a stale or empty menu. Lookups of filePath get the fallback
+    std::string fallbackPath = getFallbackPath(filePath);
+    if (Catalog::write(fallbackPath, data, directories) && catalog.open(fallbackPath)) {
+        std::cerr << "Unable to save cache file " << filePath << ", using "
+                  << fallbackPath << " until the next start" << std::endl;
+        catalogPath = filePath;
+    } else {
+        std::cerr << "Unable to save cache file " << filePath
+                  << " or " << fallbackPath << ", the menu keeps the previous cache" << std::endl;
+    }
+    return false;
+}
+
+std::string MenuCache::getFallbackPath(const std::string& filePath) {
+    return "/tmp/simplermenu_plus_" + std::filesystem::path(filePath).filename().string();
+}
+
+const Catalog& MenuCache::loadFromCache(const std::string& filePath) {
+    if (catalog.isOpen() && catalogPath == filePath) {
+        return catalog;
+    }
+
+    // A failed open keeps the previous mapping, the menu may still point
+    // into it
+    if (catalog.open(filePath)) {
+        catalogPath = filePath;
+    } else {
+        std::cerr << "Unable to load cache file: " << filePath << std::endl;
+    }
+
+    return catalog;
 }
 
 bool MenuCache::updateCacheItem(const std::string& filePath, const std::string& itemPath, const std::string& newCore) {
-    // Load and update the in-memory cache
-    std::vector<CachedMenuItem> updatedData = loadFromCache(filePath);
+    const Catalog& current = loadFromCache(filePath);
+
+    // Rebuild the catalog contents with the updated core
+    std::vector<CachedMenuItem> updatedData;
+    updatedData.reserve(current.size());
 
-    // Find and update the item with the specified path
     bool itemFound = false;
-    for (auto& item : updatedData) {
-        if (item.path == itemPath) {
-            item.core = newCore;
+    for (std::size_t i = 0; i < current.size(); i++) {
+        updatedData.push_back(current.getItem(i));
+        if (!itemFound && updatedData.back().path == itemPath) {
+            updatedData.back().core = newCore;
             itemFound = true;
-            break;
         }
     }
 
@@ -83,38 +193,107 @@ bool MenuCache::updateCacheItem(const std::string& filePath, const std::string&
         return false; // Item not found
     }
 
-    // Update in-memory cache
-    inMemoryCache[filePath] = updatedData;
+    std::vector<CachedDirectory> directories;
+    directories.reserve(current.getDirectoryCount());
+    for (std::size_t i = 0; i < current.getDirectoryCount(); i++) {
+        directories.push_back(current.getDirectory(i));
+    }
 
-    // Now update the file using RapidJSON
-    rapidjson::Document doc;
-    doc.SetArray();
-    rapidjson::Document::AllocatorType& allocator = doc.GetAllocator();
+    return saveToCache(filePath, updatedData, directories);
+}
 
-    for (const auto& item : updatedData) {
-        rapidjson::Value obj(rapidjson::kObjectType);
-        obj.AddMember("section", rapidjson::Value(item.section.c_str(), allocator), allocator);
-        obj.AddMember("folder", rapidjson::Value(item.folder.c_str(), allocator), allocator);
-        obj.AddMember("rom", rapidjson::Value(item.rom.c_str(), allocator), allocator);
-        obj.AddMember("path", rapidjson::Value(item.path.c_str(), allocator), allocator);
-        obj.AddMember("core", rapidjson::Value(item.core.c_str(), allocator), allocator);
-        doc.PushBack(obj, allocator);
+bool MenuCache::cacheExists(const std::string& filePath) {
+    std::ifstream infile(filePath);
+    return infile.good();
+}
+
+bool MenuCache::exportToJSON(const std::string& filePath) {
+    if (!catalog.isOpen()) {
+        return false;
     }
 
     FILE* fp = fopen(filePath.c_str(), "w");
     if (!fp) {
-        return false; // Could not open file for writing
+        return false;
     }
     char writeBuffer[65536];
     rapidjson::FileWriteStream os(fp, writeBuffer, sizeof(writeBuffer));
     rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(os);
-    doc.Accept(writer);
+
+    // Items are written straight from the catalog mapping, no DOM involved
+    writer.StartObject();
+
+    writer.Key("directories");
+    writer.StartArray();
+    for (std::size_t i = 0; i < catalog.getDirectoryCount(); i++) {
+        CachedDirectory dir = catalog.getDirectory(i);
+        writer.StartObject();
+        writer.Key("section");
+        writer.String(dir.section.c_str());
+        writer.Key("folder");
+        writer.String(dir.folder.c_str());
+        writer.Key("path");
+        writer.String(dir.path.c_str());
+        writer.Key("mtime");
+        writer.Int64(dir.mtime);
+        writer.Key("entries");
+        writer.Uint64(dir.entries);
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.Key("items");
+    writer.StartArray();
+    for (std::size_t i = 0; i < catalog.size(); i++) {
+        writer.StartObject();
+        writer.Key("section");
+        writer.String(catalog.getSection(i));
+        writer.Key("folder");
+        writer.String(catalog.getFolder(i));
+        writer.Key("rom");
+        writer.String(catalog.getRom(i));
+        writer.Key("path");
+        writer.String(catalog.getPath(i));
+        writer.Key("core");
+        writer.String(catalog.getCore(i));
+        writer.EndObject();
+    }
+    writer.EndArray();
+
+    writer.EndObject();
+    os.Flush();
     fclose(fp);
 
-    return true; // Update successful
+    return true;
 }
 
-bool MenuCache::cacheExists(const std::string& filePath) {
-    std::ifstream infile(filePath);
-    return infile.good();
+bool MenuCache::importFromJSON(const std::string& filePath,
+                               std::vector<CachedMenuItem>& data,
+                               std::vector<CachedDirectory>& directories) {
+    FILE* fp = fopen(filePath.c_str(), "r");
+    if (!fp) return false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    char readBuffer[65536];
+    rapidjson::FileReadStream is(fp, readBuffer, sizeof(readBuffer));
+    CacheJSONHandler handler(data, directories);
+    rapidjson::Reader reader;
+    rapidjson::ParseResult result = reader.Parse(is, handler);
+    fclose(fp);
+
+    if (!result) {
+        std::cerr << "Error parsing " << filePath << " at offset " 
+                  << result.Offset() << std::endl;
+        data.clear();
+        directories.clear();
+        return false;
+    }
+
+    std::cout << "Imported " << data.size() << " items from " << filePath << " in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start).count()
+              << " ms" << std::endl;
+
+    return true;
 }
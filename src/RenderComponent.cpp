@@ -5,22 +5,45 @@
 #include <SDL/SDL_image.h>
 #include <filesystem>
 #include <SDL/SDL_gfxPrimitives.h>
-#include <SDL/SDL_rotozoom.h>
 #include <SDL/SDL_image.h>
 #include <fstream>
+#include <algorithm>
+#include <cstdlib>
 
 #include "RenderComponent.h"
 #include "Configuration.h"
+#include "FontRegistry.h"
 
-std::unordered_map<std::string, SDL_Surface*> RenderComponent::thumbnailCache;
 
 std::unordered_map<std::string, std::string> RenderComponent::aliasMap;
 
+namespace {
+
+// The current background and both prefetched neighbours must fit, or
+// storing a neighbour evicts the one on screen and every move decodes again.
+// Backgrounds are at most screen sized at 32 bpp
+std::size_t getBackgroundBudget(Configuration& cfg) {
+    std::size_t configured = static_cast<std::size_t>(
+        std::max(0, cfg.getInt(Configuration::Key::BACKGROUND_CACHE_KB, 6144))) * 1024;
+    std::size_t screenBytes = static_cast<std::size_t>(std::max(0, cfg.getInt(Configuration::Key::SCREEN_WIDTH)))
+        * std::max(0, cfg.getInt(Configuration::Key::SCREEN_HEIGHT)) * 4;
+    // A little more per entry for its key and bookkeeping
+    return std::max(configured, 3 * (screenBytes + 1024));
+}
+
+}
+
 RenderComponent::RenderComponent(Configuration& cfg, Theme& theme) 
-    : cfg(cfg), theme(theme) {
+    : cfg(cfg), theme(theme), layout(theme.getLayout()),
+      thumbnailCache(static_cast<std::size_t>(cfg.getInt(Configuration::Key::THUMBNAIL_CACHE_KB, 8192)) * 1024),
+      backgroundCache(getBackgroundBudget(cfg)),
+      textCache(static_cast<std::size_t>(cfg.getInt(Configuration::Key::TEXT_CACHE_KB, 4096)) * 1024) {
+
+    screenHeight = cfg.getInt(Configuration::Key::SCREEN_HEIGHT);
+    screenWidth = cfg.getInt(Configuration::Key::SCREEN_WIDTH);
 
-    screenHeight = cfg.getInt(Configuration::SCREEN_HEIGHT);
-    screenWidth = cfg.getInt(Configuration::SCREEN_WIDTH);
+    prefetchAhead = std::max(0, cfg.getInt(Configuration::Key::THUMBNAIL_PREFETCH_AHEAD, 4));
+    prefetchBehind = std::max(0, cfg.getInt(Configuration::Key::THUMBNAIL_PREFETCH_BEHIND, 1));
 
     lastSection = "";
     lastFolder = "";
@@ -34,15 +57,14 @@ RenderComponent::~RenderComponent() {
     if(background) {
         SDL_FreeSurface(background);
     }
+    // The cache owns thumbnails, only the reference held on screen is ours
     if(thumbnail) {
         SDL_FreeSurface(thumbnail);
     }
-    if(tmpThumbnail) {
-        SDL_FreeSurface(tmpThumbnail);
-    }
-    if(font) {
-        TTF_CloseFont(font);
+    if(fpsBacking) {
+        SDL_FreeSurface(fpsBacking);
     }
+    clearSectionOverlays();
     if(screen) {
         SDL_FreeSurface(screen);
     }
@@ -50,78 +72,24 @@ RenderComponent::~RenderComponent() {
 }
 
 void RenderComponent::drawSection(const std::string& name, int numSystems) {
-
-    std::string backgroundPath = 
-                cfg.get(Configuration::HOME_PATH) + "/" +
-                cfg.get(Configuration::THEME_PATH) + 
-                std::to_string(cfg.getInt(Configuration::SCREEN_WIDTH)) + "x" +
-                std::to_string(cfg.getInt(Configuration::SCREEN_HEIGHT)) + "/" +
-                cfg.get(Configuration::THEME) + "/" +
-                theme.getValue("GENERAL.section_groups_folder") +
-                helper.getFilenameWithoutExtension(name) + ".png";
+    // Nothing on this screen changes without input
+    if (!needsFullRedraw()) {
+        return;
+    }
 
     if(background == nullptr || lastSection != name) {
-    	setBackground(backgroundPath);
+    	setBackground(getSectionBackgroundPath(name));
         lastSection = name;
     }
     SDL_BlitSurface(background, NULL, screen, NULL);
 
-    if (theme.getValue("GENERAL.display_section_group_name") == "1") {
-        SDL_Color white = {255, 255, 255};
-
-        // Remove extension from section and transform to uppercase
-        std::filesystem::path ss(name);
-        std::string sectionName(ss.stem().string()); 
-        transform(sectionName.begin(), sectionName.end(), sectionName.begin(), ::toupper);
-    
-        int sectionFontSize = 96;
-        if(screenWidth == 320) {
-            sectionFontSize = 48;
+    if (layout.displaySectionGroupName) {
+        // Section title with translucent background, composed once
+        SDL_Surface* overlay = getSectionOverlay(name);
+        if (overlay) {
+            SDL_Rect dstRect = {0, static_cast<Sint16>((screenHeight - overlay->h) / 2), 0, 0};
+            AlphaBlend::blit(overlay, nullptr, screen, &dstRect);
         }
-    
-        TTF_Font* titleFont = TTF_OpenFont(theme.getValue(Configuration::THEME_FONT, true).c_str(), sectionFontSize);  // Adjust font path and size as necessary
-        if (!titleFont) {
-            // Handle error
-            std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
-            return;
-        }       
-        SDL_Surface* sectionNameSurface = TTF_RenderText_Blended(titleFont, sectionName.c_str(), {255,255,255});
-        TTF_CloseFont(titleFont);   
-
-        // Add section title with translucent background
-        SDL_Rect dstRect;
-        dstRect.x = (screen->w - sectionNameSurface->w) / 2;
-        dstRect.y = (screen->h - sectionNameSurface->h) / 2;
-        dstRect.w = sectionNameSurface->w;
-        dstRect.h = sectionNameSurface->h;
-
-        // Create a semi-transparent surface for the background
-        SDL_Surface* rawTransparentBg = SDL_CreateRGBSurface(0, screenWidth, dstRect.h, 32, 0, 0, 0, 0);
-
-        // Enable blending for the surface
-        SDL_SetAlpha(rawTransparentBg, SDL_SRCALPHA, 127);
-
-        SDL_FillRect(rawTransparentBg, NULL, SDL_MapRGBA(rawTransparentBg->format, 0, 0, 0, 10)); // Fill with black color and 50% opacity
-
-        SDL_Surface* transparentBg = SDL_DisplayFormatAlpha(rawTransparentBg);
-
-        SDL_Rect fadeRect = {0, screenHeight / 2 - sectionNameSurface->h / 2,
-                            screenWidth,
-                            screenHeight / 2 + sectionNameSurface->h / 2};
-
-        // Render the semi-transparent background
-        SDL_BlitSurface(transparentBg, NULL, screen, &fadeRect);
-
-        SDL_Surface* convertedFolderNameSurface = SDL_DisplayFormatAlpha(sectionNameSurface);
-
-        // Render the text on top of the semi-transparent background
-        SDL_BlitSurface(convertedFolderNameSurface, NULL, screen, &dstRect);
-
-        // Free surfaces
-        SDL_FreeSurface(sectionNameSurface);
-        SDL_FreeSurface(rawTransparentBg);
-        SDL_FreeSurface(transparentBg);
-        SDL_FreeSurface(convertedFolderNameSurface);
     }
 
     // Decide on the x, y positions, colors, and other styling details
@@ -130,9 +98,14 @@ void RenderComponent::drawSection(const std::string& name, int numSystems) {
 }
 
 void RenderComponent::drawFolder(const std::string& name, const std::string& path, int numRoms) {
-    std::string backgroundPath = cfg.getThemePath() + theme.getValue(name + ".logo");
+    // Nothing on this screen changes without input
+    if (!needsFullRedraw()) {
+        return;
+    }
 
-    if(theme.getValue(name + ".logo") != "NOT FOUND") {
+    std::string backgroundPath = getFolderLogoPath(name);
+
+    if(!backgroundPath.empty()) {
 	    if(background == nullptr || lastFolder != name) {
        	    setBackground(backgroundPath);
             lastFolder = name;
@@ -140,108 +113,248 @@ void RenderComponent::drawFolder(const std::string& name, const std::string& pat
     	SDL_BlitSurface(background, NULL, screen, NULL);
     } else {
         clearScreen();
-        renderText(name, cfg.getInt(Configuration::SCREEN_WIDTH) / 2 , cfg.getInt(Configuration::SCREEN_HEIGHT) / 2 , {255, 255, 255}, 1); 
+        renderText(name, cfg.getInt(Configuration::Key::SCREEN_WIDTH) / 2 , cfg.getInt(Configuration::Key::SCREEN_HEIGHT) / 2 , {255, 255, 255}, 1); 
     }
 
     // As before, determine x, y positions and styles
     //renderText(name, 50, 50, {255, 255, 255}); 
     //renderText(path, 50, 100, {200, 200, 200}); 
 
-    if(theme.getIntValue(Configuration::DISPLAY_GAME_COUNT) == 1 ) {
-        int x = theme.getIntValue(Configuration::GAME_COUNT_X);
-        int y = theme.getIntValue(Configuration::GAME_COUNT_Y);
-        SDL_Color color = theme.getColor(Configuration::GAME_COUNT_FONT_COLOR);
-        renderText(std::to_string(numRoms) + (numRoms == 1 ? " GAME" : " GAMES"), x, y, color, theme.getIntValue(Configuration::GAME_COUNT_ALIGNMENT));
+    if(layout.displayGameCount) {
+        int x = layout.gameCountX;
+        int y = layout.gameCountY;
+        SDL_Color color = layout.gameCountFontColor;
+        renderText(std::to_string(numRoms) + (numRoms == 1 ? " GAME" : " GAMES"), x, y, color, layout.gameCountAlignment);
+    }
+
+}
+
+SDL_Surface* RenderComponent::getSectionOverlay(const std::string& name) {
+    auto it = sectionOverlays.find(name);
+    if (it != sectionOverlays.end()) {
+        return it->second;
+    }
+
+    // Remove extension from section and transform to uppercase
+    std::filesystem::path ss(name);
+    std::string sectionName(ss.stem().string()); 
+    transform(sectionName.begin(), sectionName.end(), sectionName.begin(), ::toupper);
+
+    int sectionFontSize = 96;
+    if(screenWidth == 320) {
+        sectionFontSize = 48;
+    }
+
+    TTF_Font* titleFont = FontRegistry::getInstance().getFont(layout.font, sectionFontSize);
+    if (!titleFont) {
+        // Handle error
+        std::cerr << "Failed to load font: " << TTF_GetError() << std::endl;
+        return nullptr;
+    }
+    SDL_Surface* text = textCache.get(titleFont, sectionName, {255,255,255});
+    if (!text) {
+        return nullptr;
+    }
+
+    // A screen wide black band at 50% opacity with the title over it, in
+    // the premultiplied display format of the text
+    SDL_PixelFormat* fmt = text->format;
+    SDL_Surface* overlay = SDL_CreateRGBSurface(SDL_SWSURFACE, screenWidth, text->h, 32,
+                                                fmt->Rmask, fmt->Gmask, fmt->Bmask, fmt->Amask);
+    if (!overlay) {
+        return nullptr;
+    }
+    SDL_FillRect(overlay, nullptr, SDL_MapRGBA(overlay->format, 0, 0, 0, 127));
+
+    SDL_Rect textRect = {static_cast<Sint16>((screenWidth - text->w) / 2), 0, 0, 0};
+    AlphaBlend::blit(text, nullptr, overlay, &textRect);
+
+    sectionOverlays.emplace(name, overlay);
+    return overlay;
+}
+
+void RenderComponent::clearSectionOverlays() {
+    for (auto& entry : sectionOverlays) {
+        SDL_FreeSurface(entry.second);
     }
+    sectionOverlays.clear();
+}
+
+void RenderComponent::languageChanged() {
+    clearSectionOverlays();
+    invalidate();
+}
+
+std::string RenderComponent::getSectionBackgroundPath(std::string_view name) {
+    return layout.sectionGroupsPath +
+           helper.getFilenameWithoutExtension(std::string(name)) + ".png";
+}
+
+std::string RenderComponent::getFolderLogoPath(std::string_view name) {
+    // Empty when the theme has no logo for the folder
+    auto it = layout.logos.find(std::string(name));
+    return it != layout.logos.end() ? it->second : "";
+}
+
+void RenderComponent::prefetchSections(std::string_view previous, std::string_view next) {
+    // Neighbours only change with the screen
+    if (!needsFullRedraw()) {
+        return;
+    }
+    prefetchBackgrounds({getSectionBackgroundPath(next), getSectionBackgroundPath(previous)});
+}
 
+void RenderComponent::prefetchFolders(std::string_view previous, std::string_view next) {
+    if (!needsFullRedraw()) {
+        return;
+    }
+    prefetchBackgrounds({getFolderLogoPath(next), getFolderLogoPath(previous)});
 }
 
-void RenderComponent::drawRomList(const std::string& folderName, const std::vector<std::pair<std::string, std::string>>& romData, int currentRomIndex) {
+void RenderComponent::prefetchBackgrounds(std::vector<std::string> paths) {
+    updateBackgrounds();
 
-    std::string backgroundPath = cfg.get(Configuration::HOME_PATH) + "/" +
-                                 cfg.get(Configuration::THEME_PATH) + 
-                                 std::to_string(screenWidth) + "x" +
-                                 std::to_string(screenHeight) + "/" +
-                                 cfg.get(Configuration::THEME) + "/" +
-                                 theme.getValue(Configuration::THEME_BACKGROUND);
+    // A full redraw spans several frames, asking again for the image being
+    // decoded would decode it twice
+    if (paths == backgroundPrefetch) {
+        return;
+    }
+    backgroundPrefetch = paths;
+
+    std::vector<ImageRequest> requests;
+    for (std::string& path : paths) {
+        if (!path.empty() && !backgroundCache.contains(path)) {
+            requests.push_back({std::move(path), 0, 0});
+        }
+    }
+    backgroundLoader.request(std::move(requests));
+}
+
+void RenderComponent::updateBackgrounds() {
+    ImageResult result;
+    while (backgroundLoader.poll(result)) {
+        SDL_Surface* surface = nullptr;
+        if (result.surface) {
+            surface = SDL_DisplayFormat(result.surface);
+            SDL_FreeSurface(result.surface);
+        }
+        backgroundCache.put(result.path, surface);
+    }
+}
+
+void RenderComponent::drawRomList(const Folder& folder, int currentRomIndex) {
+
+    // Without input only the scrolling title of the selected rom and its
+    // thumbnail, once decoded, change. Repaint just those
+    if (!needsFullRedraw()) {
+        if (selectedRow >= 0 && updateScroll()) {
+            scrollFramesLeft = screenBuffers;
+        }
+        if (scrollFramesLeft > 0) {
+            scrollFramesLeft--;
+            restoreBackground(selectedRowRect);
+            drawSelectedTitle();
+            markDirty(selectedRowRect);
+        }
+
+        if (updateThumbnail()) {
+            thumbnailFramesLeft = screenBuffers;
+        }
+        if (thumbnailFramesLeft > 0) {
+            thumbnailFramesLeft--;
+            SDL_Rect artRect = getArtRect();
+            restoreBackground(artRect);
+            drawThumbnail();
+            markDirty(artRect);
+        }
+        return;
+    }
 
 	if (background == nullptr || lastRom == -1) {
-        setBackground(backgroundPath);
+        setBackground(layout.background);
         lastRom = currentRomIndex;
     }
     SDL_BlitSurface(background, NULL, screen, NULL);
 
     // Set rom list starting position and item separation
-    int startX = theme.getIntValue(Configuration::GAME_LIST_X);
-    int startY = theme.getIntValue(Configuration::GAME_LIST_Y);
-    int stepY = theme.getIntValue(Configuration::ITEMS_SEPARATION);
+    int startX = layout.gameListX;
+    int startY = layout.gameListY;
+    int stepY = layout.itemsSeparation;
 
-    int itemsPerPage = theme.getIntValue(Configuration::ITEMS);
+    int itemsPerPage = layout.items;
 
-    // Calculate number of pages FIXME: move that to the constructor
-    int total_pages = (romData.size() + itemsPerPage - 1)/ itemsPerPage;
+    const MenuRange<Rom> roms = folder.getRoms();
+    if (roms.empty()) {
+        return;
+    }
+    int total_pages = (roms.size() + itemsPerPage - 1)/ itemsPerPage;
 
     int currentPage = currentRomIndex / itemsPerPage;
     int startIndex = currentPage * itemsPerPage;
-    int endIndex = std::min<int>(startIndex + itemsPerPage, romData.size());
+    int endIndex = std::min<int>(startIndex + itemsPerPage, roms.size());
+
+    // Only the visible page is read from the menu, and only when it changes
+    if (pageFirstItem != roms[startIndex].getItem()) {
+        pageFirstItem = roms[startIndex].getItem();
+        pageAliases.resize(endIndex - startIndex);
+        for (int i = startIndex; i < endIndex; i++) {
+            pageAliases[i - startIndex] = getAlias(std::string(roms[i].getTitle()));
+        }
+        pageTitle = folder.getTitle();
+        pageInfo = std::to_string(currentPage + 1) + " / " + std::to_string(total_pages);
+    }
+
+    animating = false;
 
     // for (int i = 0; i < theme.getIntValue(Configuration::ITEMS); i++) {
     for (int i = startIndex; i < endIndex; i++) {
         SDL_Color color = (i == currentRomIndex) ? 
-            theme.getColor(Configuration::SEL_ITEM_FONT_COLOR) :
-            theme.getColor(Configuration::ITEMS_FONT_COLOR);
-        std::string alias = getAlias(romData[i].first);
+            layout.selectedItemFontColor :
+            layout.itemsFontColor;
+        const std::string& alias = pageAliases[i - startIndex];
 
-        // Determine text width
-        SDL_Surface* textSurface = TTF_RenderText_Blended(font, alias.c_str(), color);
-        int titleWidth = textSurface->w;
+        // Determine text width, rom names are drawn from the glyph atlas
+        int titleWidth = glyphAtlas.getTextWidth(font, alias);
+        Uint16 titleHeight = TTF_FontHeight(font);
 
         // TODO replace clipWidth the correct width based on theme.ini settings
-        int clipWidth = theme.getIntValue("GENERAL.game_list_w");
+        int clipWidth = layout.gameListW;
 
         // Create the scrolling view for titles that are too wide
         if(i == currentRomIndex) {
-            if (i == currentRomIndex && SDL_GetTicks() - selectTime > SCROLL_TIMEOUT) {
-                if (scrollPixelPosition < titleWidth - clipWidth) {
-                    scrollPixelPosition += 1;  // Increment by 1 pixel. Adjust for faster scrolling.
-                    if (scrollPixelPosition == titleWidth - clipWidth) {
-                        // Record the time when scrolling completes
-                        scrollEndTime = SDL_GetTicks();
-                    }
-                } else if (SDL_GetTicks() - scrollEndTime > END_SCROLL_PAUSE) {
-                    // Reset the scroll position after the timeout period has elapsed
-                    scrollPixelPosition = 0;
-                    selectTime = SDL_GetTicks();
-                }
-            }
-            SDL_Rect destRect = {static_cast<Sint16>(startX - scrollPixelPosition), startY, 0, 0};  // Adjust x position by scrollPixelPosition
-            SDL_Rect clipRect = {startX, startY, clipWidth, static_cast<Uint16>(textSurface->h)}; // Ensure text doesn't spill over the intended area
+            animating = titleWidth > clipWidth;
+            selectedRow = i - startIndex;
+            selectedTitleWidth = titleWidth;
+            selectedRowRect = {static_cast<Sint16>(startX), static_cast<Sint16>(startY),
+                               static_cast<Uint16>(clipWidth), titleHeight};
+            updateScroll();
+
+            SDL_Rect clipRect = selectedRowRect; // Ensure text doesn't spill over the intended area
 
             SDL_SetClipRect(screen, &clipRect);
-            SDL_BlitSurface(textSurface, nullptr, screen, &destRect);
+            glyphAtlas.drawText(screen, font, alias, color, startX - scrollPixelPosition, startY);  // Adjust x position by scrollPixelPosition
         } else {
-            SDL_Rect clipRect = {startX, startY, clipWidth, static_cast<Uint16>(textSurface->h)}; // Ensure text doesn't spill over the intended area
+            SDL_Rect clipRect = {startX, startY, clipWidth, titleHeight}; // Ensure text doesn't spill over the intended area
 
             SDL_SetClipRect(screen, &clipRect);
-            SDL_BlitSurface(textSurface, nullptr, screen, &clipRect);
+            glyphAtlas.drawText(screen, font, alias, color, startX, startY);
         }
 
         SDL_SetClipRect(screen, NULL);  // Reset the clip rect
-        SDL_FreeSurface(textSurface);
 
         if (i == currentRomIndex) {
             // Add Rom title 
-            int x = theme.getIntValue(Configuration::ART_X) + theme.getIntValue(Configuration::ART_MAX_W)/2;
-            int y = theme.getIntValue(Configuration::ART_Y) +
-                    theme.getIntValue(Configuration::ART_MAX_H) +
-                    theme.getIntValue(Configuration::ART_TXT_DIST_FROM_PIC) +
-                    theme.getIntValue(Configuration::ART_TXT_DIST_FROM_PIC);
+            int x = layout.artX + layout.artMaxW/2;
+            int y = layout.artY +
+                    layout.artMaxH +
+                    layout.artTextDistanceFromPicture +
+                    layout.artTextDistanceFromPicture;
         
             if(alias.find("/") != std::string::npos) {
                 size_t position = alias.find("/");
                 std::string firstLine = alias.substr(0, position - 1);
                 std::string secondLine = alias.substr(position + 2);
-                int separation = theme.getIntValue(Configuration::ART_TXT_DIST_FROM_PIC) / 2;
+                int separation = layout.artTextDistanceFromPicture / 2;
 
                 renderText(firstLine, x, y - separation, {255, 255, 255},1);
                 renderText(secondLine, x, y + separation, {255, 255, 255},1);
@@ -251,54 +364,84 @@ void RenderComponent::drawRomList(const std::string& folderName, const std::vect
         }
 
 
-
-        // Display pagination page number / total_pages at the bottom
-        std::string pageInfo = std::to_string(currentPage + 1) + " / " + std::to_string(total_pages);
-        int x = theme.getIntValue(Configuration::TEXT2_X);
-        int y = theme.getIntValue(Configuration::TEXT2_Y);
-
-        renderText(pageInfo, x, y, {255, 255, 255}, theme.getIntValue(Configuration::TEXT2_ALIGNMENT));
-
         startY += stepY;
     }
 
-    // Load Thumbnail
-    if(thumbnail == nullptr || lastRom != currentRomIndex) {
-        loadThumbnail(romData[currentRomIndex].second);
+    // Display pagination page number / total_pages at the bottom
+    renderText(pageInfo, layout.text2X, layout.text2Y, {255, 255, 255}, layout.text2Alignment);
+
+    // Load Thumbnail, the previous art stays on screen until it is decoded
+    if(thumbnailItem != roms[currentRomIndex].getItem()) {
+        loadThumbnail(roms, currentRomIndex);
+        thumbnailItem = roms[currentRomIndex].getItem();
         lastRom = currentRomIndex;
     }
-    Sint16 x = theme.getIntValue(Configuration::ART_X); 
-    Sint16 y = theme.getIntValue(Configuration::ART_Y); 
-    Uint16 w = theme.getIntValue(Configuration::ART_MAX_W); 
-    Uint16 h = theme.getIntValue(Configuration::ART_MAX_H); 
-    SDL_Rect destRect = {x, y, w, h};
-    SDL_BlitSurface(thumbnail, nullptr, screen, &destRect);
+    updateThumbnail();
+    thumbnailFramesLeft = 0;
+    drawThumbnail();
 
     // Add Folder Title
-    renderText(folderName, theme.getIntValue(Configuration::TEXT1_X), theme.getIntValue(Configuration::TEXT1_Y), {255, 255, 255}, theme.getIntValue(Configuration::TEXT2_ALIGNMENT)); 
+    renderText(pageTitle, layout.text1X, layout.text1Y, {255, 255, 255}, layout.text2Alignment); 
+}
+
+bool RenderComponent::updateScroll() {
+    int previousPosition = scrollPixelPosition;
+    int maxScroll = selectedTitleWidth - selectedRowRect.w;
+
+    if (SDL_GetTicks() - selectTime > SCROLL_TIMEOUT) {
+        if (scrollPixelPosition < maxScroll) {
+            scrollPixelPosition += 1;  // Increment by 1 pixel. Adjust for faster scrolling.
+            if (scrollPixelPosition == maxScroll) {
+                // Record the time when scrolling completes
+                scrollEndTime = SDL_GetTicks();
+            }
+        } else if (SDL_GetTicks() - scrollEndTime > END_SCROLL_PAUSE) {
+            // Reset the scroll position after the timeout period has elapsed
+            scrollPixelPosition = 0;
+            selectTime = SDL_GetTicks();
+        }
+    }
+
+    return scrollPixelPosition != previousPosition;
+}
+
+void RenderComponent::drawSelectedTitle() {
+    SDL_Rect clipRect = selectedRowRect;
+
+    SDL_SetClipRect(screen, &clipRect);
+    glyphAtlas.drawText(screen, font, pageAliases[selectedRow], layout.selectedItemFontColor,
+                        selectedRowRect.x - scrollPixelPosition, selectedRowRect.y);
+    SDL_SetClipRect(screen, NULL);
 }
 
 void RenderComponent::drawAppSettings(const std::string& settingsTitle, std::vector<Settings::I18nSetting> settingList, int currentSettingIndex) {
+    // Nothing on this screen changes without input
+    if (!needsFullRedraw()) {
+        return;
+    }
 
-    std::string backgroundPath = cfg.get(Configuration::HOME_PATH) + "assets/settings.png";
-    std::string settingsFontPath = cfg.get(Configuration::HOME_PATH) + "assets/Akrobat-Bold.ttf";
+    std::string backgroundPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/settings.png";
+    std::string settingsFontPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/Akrobat-Bold.ttf";
     int settingsFontSize = 32;//FIXME: size needs to be dynamic
 
-    TTF_Font* setttingsFont = TTF_OpenFont(settingsFontPath.c_str(), settingsFontSize);
+    TTF_Font* setttingsFont = FontRegistry::getInstance().getFont(settingsFontPath, settingsFontSize);
 
 	if (background == nullptr || lastRom == -1) {
         setBackground(backgroundPath);
     }
     SDL_BlitSurface(background, NULL, screen, NULL);
 
-    std::string titleFontPath = cfg.get(Configuration::HOME_PATH) + "assets/akashi.ttf";
+    std::string titleFontPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/akashi.ttf";
     int titleFontSize = 64;//FIXME: size needs to be dynamic
 
-    TTF_Font* titleFont = TTF_OpenFont(settingsFontPath.c_str(), titleFontSize);
+    TTF_Font* titleFont = FontRegistry::getInstance().getFont(settingsFontPath, titleFontSize);
 
-    SDL_Surface* titleSurface = TTF_RenderText_Blended(titleFont, settingsTitle.c_str(), {255,255,255});
+    SDL_Surface* titleSurface = textCache.get(titleFont, settingsTitle, {255,255,255});
+    if (!titleSurface) {
+        return;
+    }
     SDL_Rect titlePos = {screenWidth / 2 - titleSurface->w /2 , 5, 0,0};
-    SDL_BlitSurface(titleSurface, nullptr, screen, &titlePos);
+    AlphaBlend::blit(titleSurface, nullptr, screen, &titlePos);
 
     // Set rom list starting position and item separation
     // FIXME: these values need to be dynamic depending on the resolution
@@ -317,15 +460,19 @@ void RenderComponent::drawAppSettings(const std::string& settingsTitle, std::vec
     // for (int i = 0; i < theme.getIntValue(Configuration::ITEMS); i++) {
     for (int i = startIndex; i < endIndex; i++) {
         SDL_Color color = (i == currentSettingIndex) ? 
-            theme.getColor(Configuration::SEL_ITEM_FONT_COLOR) :
-            theme.getColor(Configuration::ITEMS_FONT_COLOR);
+            layout.selectedItemFontColor :
+            layout.itemsFontColor;
 
         // Determine text width
-        SDL_Surface* textSurface = TTF_RenderText_Blended(
+        SDL_Surface* textSurface = textCache.get(
             setttingsFont, 
             // cfg.getKeyByIndex(Configuration::SYSTEM, i).c_str(), 
-            settingList[i].title.c_str(),
+            settingList[i].title,
             color);
+        if (!textSurface) {
+            startY += stepY;
+            continue;
+        }
 
         int titleWidth = textSurface->w;
 
@@ -334,17 +481,16 @@ void RenderComponent::drawAppSettings(const std::string& settingsTitle, std::vec
         SDL_Rect clipRect = {startX, startY, clipWidth, static_cast<Uint16>(textSurface->h)}; // Ensure text doesn't spill over the intended area
 
         SDL_SetClipRect(screen, &clipRect);
-        SDL_BlitSurface(textSurface, nullptr, screen, &clipRect);
+        AlphaBlend::blit(textSurface, nullptr, screen, &clipRect);
 
         SDL_SetClipRect(screen, NULL);  // Reset the clip rect
-        SDL_FreeSurface(textSurface);
 
         // Display pagination page number / total_pages at the bottom
         std::string pageInfo = std::to_string(currentPage + 1) + " / " + std::to_string(total_pages);
-        int x = theme.getIntValue(Configuration::TEXT2_X);
-        int y = theme.getIntValue(Configuration::TEXT2_Y);
+        int x = layout.text2X;
+        int y = layout.text2Y;
 
-        renderText(pageInfo, x, y, {255, 255, 255}, theme.getIntValue(Configuration::TEXT2_ALIGNMENT));
+        renderText(pageInfo, x, y, {255, 255, 255}, layout.text2Alignment);
 
         // Render the value to the right of the title
         // FIXME: replace with proper string once i18n is implemented
@@ -352,39 +498,46 @@ void RenderComponent::drawAppSettings(const std::string& settingsTitle, std::vec
         if (settingsValue == "INTERNAL") { 
             settingsValue = ". . .";
         } 
-        SDL_Surface* valueSurface = TTF_RenderText_Blended(setttingsFont, settingsValue.c_str(), color);
+        SDL_Surface* valueSurface = textCache.get(setttingsFont, settingsValue, color);
 
         // Position the value surface to the right of the title
-        SDL_Rect valueDestRect = {static_cast<Sint16>(screenWidth - valueSurface->w - 10), startY, 0, 0};
-        SDL_BlitSurface(valueSurface, nullptr, screen, &valueDestRect);
-        SDL_FreeSurface(valueSurface);
+        if (valueSurface) {
+            SDL_Rect valueDestRect = {static_cast<Sint16>(screenWidth - valueSurface->w - 10), startY, 0, 0};
+            AlphaBlend::blit(valueSurface, nullptr, screen, &valueDestRect);
+        }
 
         startY += stepY;
     }
-    TTF_CloseFont(titleFont);
-    TTF_CloseFont(setttingsFont);
 }
 
 void RenderComponent::drawFolderSettings(const std::string& settingsTitle, std::vector<Settings::I18nSetting> settingList, int currentSettingIndex) {
-    std::string backgroundPath = cfg.get(Configuration::HOME_PATH) + "assets/settings.png";
-    std::string settingsFontPath = cfg.get(Configuration::HOME_PATH) + "assets/Akrobat-Bold.ttf";
+    // Nothing on this screen changes without input
+    if (!needsFullRedraw()) {
+        return;
+    }
+
+    std::string backgroundPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/settings.png";
+    std::string settingsFontPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/Akrobat-Bold.ttf";
     int settingsFontSize = 32; //FIXME: size needs to be dynamic
 
-    TTF_Font* setttingsFont = TTF_OpenFont(settingsFontPath.c_str(), settingsFontSize);
+    TTF_Font* setttingsFont = FontRegistry::getInstance().getFont(settingsFontPath, settingsFontSize);
 
 	if (background == nullptr || lastRom == -1) {
         setBackground(backgroundPath);
     }
     SDL_BlitSurface(background, NULL, screen, NULL);
 
-    std::string titleFontPath = cfg.get(Configuration::HOME_PATH) + "assets/akashi.ttf";
+    std::string titleFontPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/akashi.ttf";
     int titleFontSize = 64; //FIXME: size needs to be dynamic
 
-    TTF_Font* titleFont = TTF_OpenFont(settingsFontPath.c_str(), titleFontSize);
+    TTF_Font* titleFont = FontRegistry::getInstance().getFont(settingsFontPath, titleFontSize);
 
-    SDL_Surface* titleSurface = TTF_RenderText_Blended(titleFont, settingsTitle.c_str(), {255,255,255});
+    SDL_Surface* titleSurface = textCache.get(titleFont, settingsTitle, {255,255,255});
+    if (!titleSurface) {
+        return;
+    }
     SDL_Rect titlePos = {screenWidth / 2 - titleSurface->w /2 , 5, 0,0};
-    SDL_BlitSurface(titleSurface, nullptr, screen, &titlePos);
+    AlphaBlend::blit(titleSurface, nullptr, screen, &titlePos);
 
 
     // Set rom list starting position and item separation
@@ -404,11 +557,15 @@ void RenderComponent::drawFolderSettings(const std::string& settingsTitle, std::
     // for (int i = 0; i < theme.getIntValue(Configuration::ITEMS); i++) {
     for (int i = startIndex; i < endIndex; i++) {
         SDL_Color color = (i == currentSettingIndex) ? 
-            theme.getColor(Configuration::SEL_ITEM_FONT_COLOR) :
-            theme.getColor(Configuration::ITEMS_FONT_COLOR);
+            layout.selectedItemFontColor :
+            layout.itemsFontColor;
 
         // Determine text width
-        SDL_Surface* textSurface = TTF_RenderText_Blended(setttingsFont, settingList[i].title.c_str(), color);
+        SDL_Surface* textSurface = textCache.get(setttingsFont, settingList[i].title, color);
+        if (!textSurface) {
+            startY += stepY;
+            continue;
+        }
         int titleWidth = textSurface->w;
 
         int clipWidth = (int)screenWidth*0.8;
@@ -416,52 +573,58 @@ void RenderComponent::drawFolderSettings(const std::string& settingsTitle, std::
         SDL_Rect clipRect = {startX, startY, clipWidth, static_cast<Uint16>(textSurface->h)}; // Ensure text doesn't spill over the intended area
 
         SDL_SetClipRect(screen, &clipRect);
-        SDL_BlitSurface(textSurface, nullptr, screen, &clipRect);
+        AlphaBlend::blit(textSurface, nullptr, screen, &clipRect);
 
         SDL_SetClipRect(screen, NULL);  // Reset the clip rect
-        SDL_FreeSurface(textSurface);
 
         // Display pagination page number / total_pages at the bottom
         std::string pageInfo = std::to_string(currentPage + 1) + " / " + std::to_string(total_pages);
-        int x = theme.getIntValue(Configuration::TEXT2_X);
-        int y = theme.getIntValue(Configuration::TEXT2_Y);
+        int x = layout.text2X;
+        int y = layout.text2Y;
 
-        renderText(pageInfo, x, y, {255, 255, 255}, theme.getIntValue(Configuration::TEXT2_ALIGNMENT));
+        renderText(pageInfo, x, y, {255, 255, 255}, layout.text2Alignment);
 
        // Render the value to the right of the title
-        SDL_Surface* valueSurface = TTF_RenderText_Blended(font, settingList[i].value.c_str(), color);
+        SDL_Surface* valueSurface = textCache.get(font, settingList[i].value, color);
 
         // Position the value surface to the right of the title
-        SDL_Rect valueDestRect = {static_cast<Sint16>(screenWidth - valueSurface->w - 10), startY, 0, 0};
-        SDL_BlitSurface(valueSurface, nullptr, screen, &valueDestRect);
-        SDL_FreeSurface(valueSurface);
+        if (valueSurface) {
+            SDL_Rect valueDestRect = {static_cast<Sint16>(screenWidth - valueSurface->w - 10), startY, 0, 0};
+            AlphaBlend::blit(valueSurface, nullptr, screen, &valueDestRect);
+        }
 
         startY += stepY;
     }
-    TTF_CloseFont(titleFont);
-    TTF_CloseFont(setttingsFont);
 }
 
 void RenderComponent::drawRomSettings(const std::string& settingsTitle, std::vector<Settings::I18nSetting> settingList, int currentSettingIndex) {
-    std::string backgroundPath = cfg.get(Configuration::HOME_PATH) + "assets/settings.png";
-    std::string settingsFontPath = cfg.get(Configuration::HOME_PATH) + "assets/Akrobat-Bold.ttf";
+    // Nothing on this screen changes without input
+    if (!needsFullRedraw()) {
+        return;
+    }
+
+    std::string backgroundPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/settings.png";
+    std::string settingsFontPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/Akrobat-Bold.ttf";
     int settingsFontSize = 32; //FIXME: size needs to be dynamic
 
-    TTF_Font* setttingsFont = TTF_OpenFont(settingsFontPath.c_str(), settingsFontSize);
+    TTF_Font* setttingsFont = FontRegistry::getInstance().getFont(settingsFontPath, settingsFontSize);
 
 	if (background == nullptr || lastRom == -1) {
         setBackground(backgroundPath);
     }
     SDL_BlitSurface(background, NULL, screen, NULL);
 
-    std::string titleFontPath = cfg.get(Configuration::HOME_PATH) + "assets/akashi.ttf";
+    std::string titleFontPath = cfg.get(Configuration::Key::HOME_PATH) + "assets/akashi.ttf";
     int titleFontSize = 64; //FIXME: size needs to be dynamic
 
-    TTF_Font* titleFont = TTF_OpenFont(settingsFontPath.c_str(), titleFontSize);
+    TTF_Font* titleFont = FontRegistry::getInstance().getFont(settingsFontPath, titleFontSize);
 
-    SDL_Surface* titleSurface = TTF_RenderText_Blended(titleFont, settingsTitle.c_str(), {255,255,255});
+    SDL_Surface* titleSurface = textCache.get(titleFont, settingsTitle, {255,255,255});
+    if (!titleSurface) {
+        return;
+    }
     SDL_Rect titlePos = {screenWidth / 2 - titleSurface->w /2 , 5, 0,0};
-    SDL_BlitSurface(titleSurface, nullptr, screen, &titlePos);
+    AlphaBlend::blit(titleSurface, nullptr, screen, &titlePos);
 
 
     // Set rom list starting position and item separation
@@ -481,11 +644,15 @@ void RenderComponent::drawRomSettings(const std::string& settingsTitle, std::vec
     // for (int i = 0; i < theme.getIntValue(Configuration::ITEMS); i++) {
     for (int i = startIndex; i < endIndex; i++) {
         SDL_Color color = (i == currentSettingIndex) ? 
-            theme.getColor(Configuration::SEL_ITEM_FONT_COLOR) :
-            theme.getColor(Configuration::ITEMS_FONT_COLOR);
+            layout.selectedItemFontColor :
+            layout.itemsFontColor;
 
         // Determine text width
-        SDL_Surface* textSurface = TTF_RenderText_Blended(setttingsFont, settingList[i].title.c_str(), color);
+        SDL_Surface* textSurface = textCache.get(setttingsFont, settingList[i].title, color);
+        if (!textSurface) {
+            startY += stepY;
+            continue;
+        }
         int titleWidth = textSurface->w;
 
         int clipWidth = (int)screenWidth*0.8;
@@ -493,102 +660,200 @@ void RenderComponent::drawRomSettings(const std::string& settingsTitle, std::vec
         SDL_Rect clipRect = {startX, startY, clipWidth, static_cast<Uint16>(textSurface->h)}; // Ensure text doesn't spill over the intended area
 
         SDL_SetClipRect(screen, &clipRect);
-        SDL_BlitSurface(textSurface, nullptr, screen, &clipRect);
+        AlphaBlend::blit(textSurface, nullptr, screen, &clipRect);
 
         SDL_SetClipRect(screen, NULL);  // Reset the clip rect
-        SDL_FreeSurface(textSurface);
 
         // Display pagination page number / total_pages at the bottom
         std::string pageInfo = std::to_string(currentPage + 1) + " / " + std::to_string(total_pages);
-        int x = theme.getIntValue(Configuration::TEXT2_X);
-        int y = theme.getIntValue(Configuration::TEXT2_Y);
+        int x = layout.text2X;
+        int y = layout.text2Y;
 
-        renderText(pageInfo, x, y, {255, 255, 255}, theme.getIntValue(Configuration::TEXT2_ALIGNMENT));
+        renderText(pageInfo, x, y, {255, 255, 255}, layout.text2Alignment);
 
        // Render the value to the right of the title
-        SDL_Surface* valueSurface = TTF_RenderText_Blended(font, settingList[i].value.c_str(), color);
+        SDL_Surface* valueSurface = textCache.get(font, settingList[i].value, color);
 
         // Position the value surface to the right of the title
-        SDL_Rect valueDestRect = {static_cast<Sint16>(screenWidth - valueSurface->w - 10), startY, 0, 0};
-        SDL_BlitSurface(valueSurface, nullptr, screen, &valueDestRect);
-        SDL_FreeSurface(valueSurface);
+        if (valueSurface) {
+            SDL_Rect valueDestRect = {static_cast<Sint16>(screenWidth - valueSurface->w - 10), startY, 0, 0};
+            AlphaBlend::blit(valueSurface, nullptr, screen, &valueDestRect);
+        }
 
         startY += stepY;
     }
-    TTF_CloseFont(titleFont);
-    TTF_CloseFont(setttingsFont);
 }
 
-void RenderComponent::loadThumbnail(const std::string& romPath) {
-    //std::cout << "loadThumbnail called for " << romPath << std::endl;
-
+std::string RenderComponent::getThumbnailPath(const std::string& romPath) {
     std::filesystem::path path(romPath);
     std::string romNameWithoutExtension = path.stem().string();
     std::string basePath = path.parent_path().string();
-    std::string imagesPath = cfg.get(Configuration::IMAGES_PATH);
-    std::string thumbnailType = cfg.get(Configuration::THUMBNAIL_TYPE);
+    std::string imagesPath = cfg.get(Configuration::Key::IMAGES_PATH);
+    std::string thumbnailType = cfg.get(Configuration::Key::THUMBNAIL_TYPE);
 
     std::string thumbnailExtension = thumbnailType == "default" ? ".png" : "-" + thumbnailType + ".png";
-    std::string thumbnailPath = basePath + imagesPath + romNameWithoutExtension + thumbnailExtension;
+    return basePath + imagesPath + romNameWithoutExtension + thumbnailExtension;
+}
+
+SDL_Rect RenderComponent::getArtRect() {
+    Sint16 x = layout.artX; 
+    Sint16 y = layout.artY; 
+    Uint16 w = layout.artMaxW; 
+    Uint16 h = layout.artMaxH; 
+    return {x, y, w, h};
+}
 
-    // If thumbnail is already in cache, set it and return
-    if (thumbnailCache.find(thumbnailPath) != thumbnailCache.end()) {
-        thumbnail = thumbnailCache[thumbnailPath];
+void RenderComponent::loadThumbnail(const MenuRange<Rom>& roms, int currentRomIndex) {
+    thumbnailPath = getThumbnailPath(std::string(roms[currentRomIndex].getPath()));
 
-        // std::cout << "loadThumbnail found in cache, returning" << std::endl;
-        return;
+    // Follow the direction of navigation. A jump of more than half the list
+    // is a wrap around, and a fast scroll looks further ahead
+    int size = roms.size();
+    int delta = thumbnailIndex >= 0 ? currentRomIndex - thumbnailIndex : 1;
+    if (std::abs(delta) > size / 2) {
+        delta = -delta;
+    }
+    int direction = delta < 0 ? -1 : 1;
+
+    Uint32 now = SDL_GetTicks();
+    bool fast = now - thumbnailSelectTime < FAST_SCROLL_INTERVAL;
+    thumbnailSelectTime = now;
+    thumbnailIndex = currentRomIndex;
+
+    std::vector<ImageRequest> requests;
+    int width = layout.artMaxW;
+    int height = layout.artMaxH;
+
+    // If thumbnail is already in cache, set it
+    SDL_Surface* cached = nullptr;
+    if (thumbnailCache.get(thumbnailPath, cached)) {
+        setThumbnail(cached);
+        thumbnailPending = false;
+        thumbnailHits++;
+    } else {
+        requests.push_back({thumbnailPath, width, height});
+        thumbnailPending = true;
+        thumbnailMisses++;
     }
 
-    // If the thumbnail doesn't exist, simply return
-    if (!std::filesystem::exists(thumbnailPath)) {
-        // std::cout << "Thumbnail not found: " << thumbnailPath << std::endl;
-        return;
+    // Prefetch the next roms in the direction of travel, then a few behind.
+    // Nothing is queued past that window, so decoding stops when the
+    // selection does
+    int ahead = std::min(prefetchAhead * (fast ? 2 : 1), size - 1);
+    int behind = std::min(prefetchBehind, size - 1 - ahead);
+    for (int i = 1; i <= ahead + behind; i++) {
+        int offset = i <= ahead ? i * direction : -(i - ahead) * direction;
+        int index = ((currentRomIndex + offset) % size + size) % size;
+        std::string path = getThumbnailPath(std::string(roms[index].getPath()));
+        if (!thumbnailCache.contains(path)) {
+            requests.push_back({std::move(path), width, height});
+        }
     }
 
-    tmpThumbnail = IMG_Load(thumbnailPath.c_str());
+    // Decode in the background, requests for roms selected before are dropped
+    thumbnailLoader.request(std::move(requests));
+}
 
-    int thumbnailWidth = theme.getIntValue(Configuration::ART_MAX_W);
-    int thumbnailHeight = theme.getIntValue(Configuration::ART_MAX_H);
+void RenderComponent::reportThumbnailHitRate() {
+    unsigned int total = thumbnailHits + thumbnailMisses;
+    if (total == 0) {
+        return;
+    }
 
-    // Check if the thumbnail needs to be resized
-    if (tmpThumbnail->w != thumbnailWidth || tmpThumbnail->h != thumbnailHeight) {
-        double scaleX = (double)thumbnailWidth / tmpThumbnail->w;
-        double scaleY = (double)thumbnailHeight / tmpThumbnail->h;
-        double scale = std::min(scaleX, scaleY);
+    std::cout << "Thumbnail cache: " << thumbnailHits << " hits, " << thumbnailMisses
+              << " misses (" << thumbnailHits * 100 / total << "% hit rate)" << std::endl;
+    thumbnailHits = 0;
+    thumbnailMisses = 0;
+}
 
-        SDL_Surface* resizedThumbnail = zoomSurface(tmpThumbnail, scale, scale, SMOOTHING_ON);
+bool RenderComponent::updateThumbnail() {
+    bool changed = false;
 
-        if (tmpThumbnail) {
-            SDL_FreeSurface(tmpThumbnail);
+    ImageResult result;
+    while (thumbnailLoader.poll(result)) {
+        SDL_Surface* surface = result.surface;
+        if (surface && !isDisplayFormat(surface)) {
+            surface = SDL_DisplayFormat(result.surface);
+            SDL_FreeSurface(result.surface);
         }
 
-        SDL_Surface* loadedSurface = resizedThumbnail;
-        if (loadedSurface) {
-            tmpThumbnail = SDL_DisplayFormat(loadedSurface);
-            SDL_FreeSurface(loadedSurface);
-        } else {
-            std::cerr << "Failed to load thumbnail: " << IMG_GetError() << std::endl;
+        if (thumbnailPending && result.path == thumbnailPath) {
+            setThumbnail(surface);
+            thumbnailPending = false;
+            changed = true;
         }
 
-        // // Free the original loaded thumbnail as it's no longer needed
-        // SDL_FreeSurface(tmpThumbnail);
-        // tmpThumbnail = resizedThumbnail;
+        // Missing art is cached too, so it isn't looked up again
+        thumbnailCache.put(result.path, surface);
     }
 
-    if (thumbnailCache.find(thumbnailPath) != thumbnailCache.end()) {
-        thumbnailCache.erase(thumbnailPath);
+    return changed;
+}
+
+bool RenderComponent::isDisplayFormat(const SDL_Surface* surface) const {
+    const SDL_PixelFormat* a = surface->format;
+    const SDL_PixelFormat* b = screen->format;
+    return a->BitsPerPixel == b->BitsPerPixel && a->Rmask == b->Rmask && a->Gmask == b->Gmask
+        && a->Bmask == b->Bmask && a->Amask == b->Amask && !a->palette;
+}
+
+void RenderComponent::setThumbnail(SDL_Surface* surface) {
+    // Hold a reference, the cache may evict the surface while it is shown
+    if (surface) {
+        surface->refcount++;
+    }
+    if (thumbnail) {
+        SDL_FreeSurface(thumbnail);
     }
+    thumbnail = surface;
+}
 
-    // Cache and set the thumbnail
-    thumbnailCache[thumbnailPath] = tmpThumbnail;
-    thumbnail = tmpThumbnail;
+void RenderComponent::drawThumbnail() {
+    if (thumbnail) {
+        SDL_Rect destRect = getArtRect();
+        SDL_BlitSurface(thumbnail, nullptr, screen, &destRect);
+    }
 }
 
-void RenderComponent::printFPS(int fps) {
-    // Display FPS page number / total_pages at the bottom
-    if(cfg.getBool(Configuration::SHOW_FPS)) {
+void RenderComponent::printFPS(int fps, int cpuLoad, int textMisses) {
+    // Display FPS, process CPU load and text rendered in the last second
+    // at the top right corner
+    if(cfg.getBool(Configuration::Key::SHOW_FPS)) {
 
-        std::string fpsText = "FPS: " + std::to_string(fps);
+        std::string fpsText = "FPS: " + std::to_string(fps) + " CPU: " + std::to_string(cpuLoad) + "%"
+                            + " TXT: " + std::to_string(textMisses);
+
+        if (fpsText != lastFpsText) {
+            lastFpsText = fpsText;
+            fpsFramesLeft = screenBuffers;
+        }
+        if (!needsFullRedraw() && fpsFramesLeft == 0) {
+            return;
+        }
+
+        // The counter is drawn over whatever the screen shows, keep a copy
+        // of what lies under it so it can be repainted on its own
+        if (!fpsBacking) {
+            int w = 0, h = 0;
+            TTF_SizeText(font, "FPS: 999 CPU: 100% TXT: 9999", &w, &h);
+            fpsRect = {static_cast<Sint16>(std::max(0, screenWidth - w - 10)), 10,
+                       static_cast<Uint16>(w), static_cast<Uint16>(h)};
+            fpsBacking = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, screen->format->BitsPerPixel,
+                                              screen->format->Rmask, screen->format->Gmask,
+                                              screen->format->Bmask, screen->format->Amask);
+        }
+        if (fpsBacking) {
+            SDL_Rect rect = fpsRect;
+            if (needsFullRedraw()) {
+                SDL_BlitSurface(screen, &rect, fpsBacking, nullptr);
+            } else {
+                SDL_BlitSurface(fpsBacking, nullptr, screen, &rect);
+                markDirty(fpsRect);
+            }
+        }
+        if (fpsFramesLeft > 0) {
+            fpsFramesLeft--;
+        }
 
         SDL_Surface* rawTextSurface = TTF_RenderText_Blended(font, fpsText.c_str(), {255,255,0});
         if (!rawTextSurface) {
@@ -601,16 +866,19 @@ void RenderComponent::printFPS(int fps) {
         if(!textSurface) {
             return;
         }
+        AlphaBlend::premultiply(textSurface);
 
-        SDL_Rect destRect = {screenWidth - textSurface->w - 10, 10, 0, 0};  // Position for page counter
-	SDL_BlitSurface(textSurface, NULL, screen, &destRect);
+        SDL_Rect destRect = {static_cast<Sint16>(screenWidth - textSurface->w - 10), 10, 0, 0};  // Position for page counter
+        SDL_SetClipRect(screen, &fpsRect);
+	AlphaBlend::blit(textSurface, nullptr, screen, &destRect);
+        SDL_SetClipRect(screen, NULL);
 
         SDL_FreeSurface(textSurface);
     }
 }
 
 void RenderComponent::loadAliases() {
-    std::ifstream infile(cfg.get(Configuration::HOME_PATH) + cfg.get(Configuration::ALIAS_PATH));
+    std::ifstream infile(cfg.get(Configuration::Key::HOME_PATH) + cfg.get(Configuration::Key::ALIAS_PATH));
     std::string line;
     while (std::getline(infile, line)) {
         size_t pos = line.find('=');
@@ -637,9 +905,50 @@ std::string RenderComponent::getAlias(const std::string& title) {
     return displayTitle;
 }
 
+void RenderComponent::markDirty(const SDL_Rect& rect) {
+    // SDL_UpdateRects needs rectangles that lie inside the screen
+    int x1 = std::max<int>(rect.x, 0);
+    int y1 = std::max<int>(rect.y, 0);
+    int x2 = std::min<int>(rect.x + rect.w, screenWidth);
+    int y2 = std::min<int>(rect.y + rect.h, screenHeight);
+    if (x1 < x2 && y1 < y2) {
+        dirtyRects.push_back({static_cast<Sint16>(x1), static_cast<Sint16>(y1),
+                              static_cast<Uint16>(x2 - x1), static_cast<Uint16>(y2 - y1)});
+    }
+}
+
+void RenderComponent::restoreBackground(const SDL_Rect& rect) {
+    SDL_Rect destRect = rect;
+    if (background) {
+        SDL_Rect srcRect = rect;
+        SDL_BlitSurface(background, &srcRect, screen, &destRect);
+    } else {
+        SDL_FillRect(screen, &destRect, SDL_MapRGB(screen->format, 0, 0, 0));
+    }
+}
+
 void RenderComponent::update() {
-    if (SDL_Flip(screen) == -1) {
+    if (fullRedrawFrames > 0) {
+        fullRedrawFrames--;
+        dirtyRects.clear();
+        if (SDL_Flip(screen) == -1) {
+            std::cerr << "SDL_Flip failed: " << SDL_GetError() << std::endl;
+        }
+        return;
+    }
+
+    // Nothing changed, the frame on screen is still valid
+    if (dirtyRects.empty()) {
+        return;
+    }
+
+    // A single buffered screen only needs the changed regions pushed. With
+    // more buffers every changed region is repainted on each of them, so a
+    // flip is enough
+    if (screenBuffers == 1) {
+        SDL_UpdateRects(screen, dirtyRects.size(), dirtyRects.data());
+    } else if (SDL_Flip(screen) == -1) {
         std::cerr << "SDL_Flip failed: " << SDL_GetError() << std::endl;
-        return;  // or handle the error as appropriate
     }
+    dirtyRects.clear();
 }
@@ -0,0 +1,62 @@
+#include "RomScanner.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+RomScanner::RomScanner(FileManager& fileManager, unsigned int maxThreads)
+    : fileManager(fileManager), maxThreads(maxThreads) {
+}
+
+unsigned int RomScanner::getThreadCount(std::size_t jobCount) const {
+    unsigned int threads = maxThreads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max<unsigned int>(1, std::min<std::size_t>(threads, jobCount));
+}
+
+void RomScanner::scanJob(const ScanJob& job, ScanResult& result) {
+    auto start = std::chrono::steady_clock::now();
+
+    result.mtime = fileManager.getModificationTime(job.directory);
+
+    if (result.mtime == job.knownMtime) {
+        result.unchanged = true;
+    } else if (result.mtime != 0) {
+        result.files = fileManager.getFiles(job.directory);
+    }
+
+    result.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<ScanResult> RomScanner::scan(const std::vector<ScanJob>& jobs) {
+    // Every job owns its own result slot, so workers never share
+    // state apart from the job counter
+    std::vector<ScanResult> results(jobs.size());
+    std::atomic<std::size_t> nextJob(0);
+
+    auto worker = [&]() {
+        for (std::size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            scanJob(jobs[i], results[i]);
+        }
+    };
+
+    unsigned int threadCount = getThreadCount(jobs.size());
+    if (threadCount == 1) {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    return results;
+}
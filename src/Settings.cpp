@@ -30,15 +30,15 @@ AppSettings::AppSettings(Configuration& cfg, I18n& i18n,
     };
 }
 
-SystemSettings::SystemSettings(Configuration& cfg, I18n& i18n, 
+SystemSettings::SystemSettings(Configuration& cfg, I18n& i18n, SystemRegistry& systems,
                                int minValue, int maxValue, int delta)
-    : Settings(cfg, i18n, minValue, maxValue, delta) {
+    : Settings(cfg, i18n, minValue, maxValue, delta), systems(systems) {
     generateCoreSettings();
 }
 
-RomSettings::RomSettings(Configuration& cfg, I18n& i18n,
+RomSettings::RomSettings(Configuration& cfg, I18n& i18n, const SystemRegistry& systems,
                           int minValue, int maxValue, int delta)
-        : Settings(cfg, i18n, minValue, maxValue, delta) {
+        : Settings(cfg, i18n, minValue, maxValue, delta), systems(systems) {
     defaultKeys = {
         Configuration::ROM_OVERCLOCK, Configuration::ROM_AUTOSTART, Configuration::CORE_OVERRIDE
     };    
@@ -131,10 +131,10 @@ std::vector<Settings::I18nSetting> RomSettings::getRomSettings() {
 void Settings::initializeSettings() {
 
     std::string themePath = 
-        cfg.get(Configuration::HOME_PATH) +
-        cfg.get(Configuration::THEME_PATH) +
-        cfg.get(Configuration::SCREEN_WIDTH) + "x" +
-        cfg.get(Configuration::SCREEN_HEIGHT) + "/";
+        cfg.get(Configuration::Key::HOME_PATH) +
+        cfg.get(Configuration::Key::THEME_PATH) +
+        cfg.get(Configuration::Key::SCREEN_WIDTH) + "x" +
+        cfg.get(Configuration::Key::SCREEN_HEIGHT) + "/";
 
     for (const auto& entry : std::filesystem::directory_iterator(themePath)) {
         if (entry.is_directory()) {
@@ -0,0 +1,261 @@
+#include "SystemRegistry.h"
+#include "IniFile.h"
+#include "Configuration.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sys/stat.h>
+#include <rapidjson/document.h>
+#include <rapidjson/filereadstream.h>
+
+namespace {
+
+std::vector<std::string> toStrings(const std::vector<std::string_view>& views) {
+    return std::vector<std::string>(views.begin(), views.end());
+}
+
+std::vector<std::string> readStringArray(const rapidjson::Value& object, const char* name) {
+    std::vector<std::string> values;
+    auto member = object.FindMember(name);
+    if (member != object.MemberEnd() && member->value.IsArray()) {
+        for (const auto& value : member->value.GetArray()) {
+            if (value.IsString()) {
+                values.emplace_back(value.GetString(), value.GetStringLength());
+            }
+        }
+    }
+    return values;
+}
+
+}
+
+SystemRegistry::SystemRegistry(const std::string& sectionGroupsPath, const std::string& systemsJsonPath)
+    : sectionGroupsPath(sectionGroupsPath), systemsJsonPath(systemsJsonPath) {
+    systemsJson = {systemsJsonPath, -1, 0};
+    refresh();
+}
+
+SystemRegistry::Source SystemRegistry::stat(const std::string& path) {
+    // A missing file is size -1, so creating it counts as a change
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return {path, -1, 0};
+    }
+    return {path, static_cast<std::int64_t>(st.st_size),
+            static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec};
+}
+
+std::vector<SystemRegistry::Source> SystemRegistry::listIniSources() const {
+    std::vector<Source> found;
+
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(sectionGroupsPath, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string filename = it->path().filename().string();
+        if (filename[0] == '.' || it->path().extension() != ".ini" || !it->is_regular_file(ec)) {
+            continue;
+        }
+        found.push_back(stat(it->path().string()));
+    }
+    if (ec) {
+        std::cerr << "Error accessing directory " << sectionGroupsPath << ": " << ec.message() << std::endl;
+    }
+
+    std::sort(found.begin(), found.end(), [](const Source& a, const Source& b) {
+        return a.path < b.path;
+    });
+    return found;
+}
+
+bool SystemRegistry::refresh() {
+    Source json = stat(systemsJsonPath);
+    std::vector<Source> inis = listIniSources();
+
+    bool jsonChanged = !(json == systemsJson);
+    if (!jsonChanged && inis == iniSources) {
+        return false;
+    }
+
+    if (jsonChanged) {
+        systemsJson = json;
+        loadDefaults();
+    }
+
+    // Sections and iniSources are parallel. Sections whose ini is unchanged
+    // are kept, unless the defaults they were merged with changed
+    std::unordered_map<std::string, std::size_t> previous;
+    if (!jsonChanged) {
+        for (std::size_t i = 0; i < iniSources.size(); i++) {
+            previous.emplace(iniSources[i].path, i);
+        }
+    }
+
+    std::vector<SectionGroup> loaded;
+    loaded.reserve(inis.size());
+    for (const Source& source : inis) {
+        auto old = previous.find(source.path);
+        if (old != previous.end() && iniSources[old->second] == source) {
+            loaded.push_back(std::move(sections[old->second]));
+        } else {
+            loaded.push_back(loadSection(source.path, std::filesystem::path(source.path).filename().string()));
+        }
+    }
+
+    sections = std::move(loaded);
+    iniSources = std::move(inis);
+    sectionIndex.clear();
+    for (std::size_t i = 0; i < sections.size(); i++) {
+        sectionIndex.emplace(sections[i].file, i);
+    }
+
+    std::cout << "System registry loaded " << sections.size() << " section groups" << std::endl;
+    return true;
+}
+
+void SystemRegistry::loadDefaults() {
+    defaults.clear();
+    if (systemsJson.size < 0) {
+        return;
+    }
+
+    FILE* file = std::fopen(systemsJsonPath.c_str(), "rb");
+    if (!file) {
+        return;
+    }
+    char buffer[65536];
+    rapidjson::FileReadStream stream(file, buffer, sizeof(buffer));
+    rapidjson::Document document;
+    document.ParseStream(stream);
+    std::fclose(file);
+
+    if (document.HasParseError() || !document.IsObject()) {
+        std::cerr << "Error parsing " << systemsJsonPath << ", ignoring it" << std::endl;
+        return;
+    }
+
+    for (auto it = document.MemberBegin(); it != document.MemberEnd(); ++it) {
+        if (!it->value.IsObject()) {
+            continue;
+        }
+        // A disabled console gives no defaults, its ini must then list
+        // everything itself
+        auto enabled = it->value.FindMember("enabled");
+        if (enabled != it->value.MemberEnd() && enabled->value.IsBool() && !enabled->value.GetBool()) {
+            continue;
+        }
+        SystemInfo info;
+        info.name.assign(it->name.GetString(), it->name.GetStringLength());
+        info.execs = readStringArray(it->value, "execs");
+        info.romDirs = readStringArray(it->value, "romDirs");
+        info.romExts = readStringArray(it->value, "romExts");
+
+        // The inis end rom dirs with a slash and rom paths are built by
+        // appending to them, systems.json leaves it out
+        for (std::string& romDir : info.romDirs) {
+            if (!romDir.empty() && romDir.back() != '/') {
+                romDir += '/';
+            }
+        }
+        defaults.emplace(info.name, std::move(info));
+    }
+}
+
+SectionGroup SystemRegistry::loadSection(const std::string& path, const std::string& file) const {
+    SectionGroup group;
+    group.file = file;
+
+    try {
+        IniFile iniFile(path);
+
+        std::string_view consoleList;
+        if (!iniFile.find(Configuration::CONSOLES_LIST, consoleList)) {
+            std::cerr << path << ": missing " << Configuration::CONSOLES_LIST << std::endl;
+            return group;
+        }
+
+        for (std::string_view consoleName : IniFile::split(consoleList)) {
+            SystemInfo info;
+            info.name = std::string(consoleName);
+
+            auto it = defaults.find(info.name);
+            const SystemInfo* fallback = it != defaults.end() ? &it->second : nullptr;
+            // CONSOLE_* ids are ".execs" and so on, the key is after the dot
+            auto read = [&](const std::string& id, std::vector<std::string>& values,
+                            const std::vector<std::string>* defaultValues) {
+                std::string_view value;
+                if (iniFile.find(consoleName, std::string_view(id).substr(1), value)) {
+                    values = toStrings(IniFile::split(value));
+                    return true;
+                }
+                if (defaultValues && !defaultValues->empty()) {
+                    values = *defaultValues;
+                    return true;
+                }
+                std::cerr << path << ": missing " << info.name << id << std::endl;
+                return false;
+            };
+            if (!read(Configuration::CONSOLE_EXECS, info.execs, fallback ? &fallback->execs : nullptr)
+                || !read(Configuration::CONSOLE_ROM_EXTS, info.romExts, fallback ? &fallback->romExts : nullptr)
+                || !read(Configuration::CONSOLE_ROM_DIRS, info.romDirs, fallback ? &fallback->romDirs : nullptr)) {
+                continue;
+            }
+
+            for (const std::string& exec : info.execs) {
+                info.cores.push_back(exec.substr(exec.find_last_of("/\\") + 1));
+            }
+            group.systems.push_back(std::move(info));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error reading " << path << ": " << e.what() << std::endl;
+    }
+
+    // Name order and one entry per console, as the menu lists them
+    std::stable_sort(group.systems.begin(), group.systems.end(), [](const SystemInfo& a, const SystemInfo& b) {
+        return a.name < b.name;
+    });
+    group.systems.erase(std::unique(group.systems.begin(), group.systems.end(),
+                                    [](const SystemInfo& a, const SystemInfo& b) { return a.name == b.name; }),
+                        group.systems.end());
+    for (std::size_t i = 0; i < group.systems.size(); i++) {
+        group.index.emplace(group.systems[i].name, i);
+    }
+    return group;
+}
+
+std::uint64_t SystemRegistry::getFingerprint() const {
+    // FNV-1a, sources are kept sorted so the order is stable
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, std::size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    auto mixSource = [&mix](const Source& source) {
+        // The NUL keeps "a" + "b..." apart from "ab" + "..."
+        mix(source.path.c_str(), source.path.size() + 1);
+        mix(&source.size, sizeof(source.size));
+        mix(&source.mtime, sizeof(source.mtime));
+    };
+
+    mixSource(systemsJson);
+    for (const Source& source : iniSources) {
+        mixSource(source);
+    }
+    return hash;
+}
+
+const SectionGroup* SystemRegistry::findSection(const std::string& file) const {
+    auto it = sectionIndex.find(file);
+    return it != sectionIndex.end() ? &sections[it->second] : nullptr;
+}
+
+const SystemInfo* SystemRegistry::find(const std::string& section, const std::string& system) const {
+    const SectionGroup* group = findSection(section);
+    if (!group) {
+        return nullptr;
+    }
+    auto it = group->index.find(system);
+    return it != group->index.end() ? &group->systems[it->second] : nullptr;
+}
@@ -0,0 +1,67 @@
+#include "TextCache.h"
+#include "AlphaBlend.h"
+
+TextCache::TextCache(std::size_t budget) : budget(budget) {
+}
+
+TextCache::~TextCache() {
+    clear();
+}
+
+SDL_Surface* TextCache::get(TTF_Font* font, const std::string& text, SDL_Color color) {
+    if (!font || text.empty()) {
+        return nullptr;
+    }
+
+    auto it = index.find({font, text, packColor(color)});
+    if (it != index.end()) {
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->surface;
+    }
+
+    misses++;
+
+    SDL_Surface* rawSurface = TTF_RenderUTF8_Blended(font, text.c_str(), color);
+    if (!rawSurface) {
+        return nullptr;
+    }
+
+    // Convert the surface to the display format while preserving alpha
+    SDL_Surface* surface = SDL_DisplayFormatAlpha(rawSurface);
+    SDL_FreeSurface(rawSurface);
+    if (!surface) {
+        return nullptr;
+    }
+    AlphaBlend::premultiply(surface);
+
+    entries.push_front({font, text, packColor(color), surface,
+                        static_cast<std::size_t>(surface->pitch) * surface->h});
+    Entry& entry = entries.front();
+    index.emplace(Key{entry.font, entry.text, entry.color}, entries.begin());
+    bytes += entry.bytes;
+
+    evict();
+
+    return surface;
+}
+
+void TextCache::evict() {
+    // The newest entry always stays, even if it is bigger than the budget
+    while (bytes > budget && entries.size() > 1) {
+        Entry& entry = entries.back();
+        index.erase({entry.font, entry.text, entry.color});
+        bytes -= entry.bytes;
+        SDL_FreeSurface(entry.surface);
+        entries.pop_back();
+    }
+}
+
+void TextCache::clear() {
+    index.clear();
+    for (Entry& entry : entries) {
+        SDL_FreeSurface(entry.surface);
+    }
+    entries.clear();
+    bytes = 0;
+}
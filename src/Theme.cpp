@@ -1,28 +1,124 @@
 #include "Theme.h"
 #include "Configuration.h"
 #include <iostream>
-#include <boost/property_tree/ptree.hpp>
-#include <boost/property_tree/ini_parser.hpp>
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
+#include "IniFile.h"
+
 Theme::Theme(std::string homePath, std::string themePath, std::string name, int screenWidth, int screenHeight) {
     loadTheme(homePath, themePath, name, screenWidth, screenHeight);
 }
 
 void Theme::loadTheme(const std::string& homePath, const std::string& themePath, const std::string& themeName, int screenWidth, int screenHeight) {
-    // Load values from .ini file using Boost.PropertyTree
-    boost::property_tree::ptree pt;
-
     baseThemePath = homePath + "/" + themePath + "/" + std::to_string(screenWidth) + "x" + std::to_string(screenHeight) + "/" + themeName + "/";
 
-    boost::property_tree::ini_parser::read_ini(baseThemePath + "theme.ini", pt);
+    IniFile iniFile(baseThemePath + "theme.ini");
+
+    // Values of the previous theme must not leak into this one
+    configValues.clear();
+    // Keys outside a section were never part of the theme
+    for (const auto& section : iniFile.getSections()) {
+        for (const IniFile::Entry* entry = section.begin; entry != section.end; ++entry) {
+            std::string fullKey;
+            fullKey.reserve(section.name.size() + 1 + entry->key.size());
+            fullKey.append(section.name).append(1, '.').append(entry->key);
+            configValues[std::move(fullKey)] = std::string(entry->value);
+        }
+    }
+
+    compileLayout();
+}
 
-    for (const auto& section : pt) {
-        for (const auto& key_value : section.second) {
-            std::string full_key = section.first + "." + key_value.first;
-            configValues[full_key] = key_value.second.get_value<std::string>();
+void Theme::compileLayout() {
+    ThemeLayout compiled;
+
+    auto path = [this](const std::string& key) {
+        auto it = configValues.find(key);
+        return it != configValues.end() ? baseThemePath + it->second : std::string();
+    };
+    auto value = [this](const std::string& key) {
+        auto it = configValues.find(key);
+        return it != configValues.end() ? it->second : std::string();
+    };
+
+    compiled.font = path(Configuration::THEME_FONT);
+    compiled.textFont = path("GENERAL.textX_font");
+    compiled.fontSize = std::max(1, parseInt("GENERAL.font_size", compiled.fontSize));
+
+    compiled.background = path(Configuration::THEME_BACKGROUND);
+    compiled.gameListX = parseInt(Configuration::GAME_LIST_X, compiled.gameListX);
+    compiled.gameListY = parseInt(Configuration::GAME_LIST_Y, compiled.gameListY);
+    compiled.gameListW = std::max(0, parseInt("GENERAL.game_list_w", compiled.gameListW));
+    compiled.items = std::max(1, parseInt(Configuration::ITEMS, compiled.items));
+    compiled.itemsSeparation = parseInt(Configuration::ITEMS_SEPARATION, compiled.itemsSeparation);
+    compiled.itemsFontColor = parseColor(Configuration::ITEMS_FONT_COLOR, compiled.itemsFontColor);
+    compiled.selectedItemFontColor = parseColor(Configuration::SEL_ITEM_FONT_COLOR, compiled.selectedItemFontColor);
+
+    compiled.artX = parseInt(Configuration::ART_X, compiled.artX);
+    compiled.artY = parseInt(Configuration::ART_Y, compiled.artY);
+    compiled.artMaxW = std::max(0, parseInt(Configuration::ART_MAX_W, compiled.artMaxW));
+    compiled.artMaxH = std::max(0, parseInt(Configuration::ART_MAX_H, compiled.artMaxH));
+    compiled.artTextDistanceFromPicture = parseInt(Configuration::ART_TXT_DIST_FROM_PIC, compiled.artTextDistanceFromPicture);
+
+    compiled.text1X = parseInt(Configuration::TEXT1_X, compiled.text1X);
+    compiled.text1Y = parseInt(Configuration::TEXT1_Y, compiled.text1Y);
+    compiled.text1Alignment = parseInt(Configuration::TEXT1_ALIGNMENT, compiled.text1Alignment);
+    compiled.text2X = parseInt(Configuration::TEXT2_X, compiled.text2X);
+    compiled.text2Y = parseInt(Configuration::TEXT2_Y, compiled.text2Y);
+    compiled.text2Alignment = parseInt(Configuration::TEXT2_ALIGNMENT, compiled.text2Alignment);
+
+    compiled.displayGameCount = parseInt(Configuration::DISPLAY_GAME_COUNT, 0) == 1;
+    compiled.gameCountX = parseInt(Configuration::GAME_COUNT_X, compiled.gameCountX);
+    compiled.gameCountY = parseInt(Configuration::GAME_COUNT_Y, compiled.gameCountY);
+    compiled.gameCountAlignment = parseInt(Configuration::GAME_COUNT_ALIGNMENT, compiled.gameCountAlignment);
+    compiled.gameCountFontColor = parseColor(Configuration::GAME_COUNT_FONT_COLOR, compiled.gameCountFontColor);
+
+    compiled.sectionGroupsPath = baseThemePath + value("GENERAL.section_groups_folder");
+    compiled.displaySectionGroupName = value("GENERAL.display_section_group_name") == "1";
+
+    // Every "<folder>.logo" key, by folder name
+    static const std::string LOGO_SUFFIX = ".logo";
+    for (const auto& entry : configValues) {
+        const std::string& key = entry.first;
+        if (key.size() > LOGO_SUFFIX.size()
+            && key.compare(key.size() - LOGO_SUFFIX.size(), LOGO_SUFFIX.size(), LOGO_SUFFIX) == 0) {
+            compiled.logos[key.substr(0, key.size() - LOGO_SUFFIX.size())] = baseThemePath + entry.second;
         }
     }
+
+    layout = std::move(compiled);
+}
+
+int Theme::parseInt(const std::string& key, int defaultValue) const {
+    auto it = configValues.find(key);
+    if (it == configValues.end()) {
+        return defaultValue;
+    }
+    try {
+        return std::stoi(it->second);
+    } catch (const std::exception& e) {
+        std::cerr << "Error converting value for key '" << key << "' to integer: " << e.what() << std::endl;
+        return defaultValue;
+    }
+}
+
+SDL_Color Theme::parseColor(const std::string& key, SDL_Color defaultValue) const {
+    auto it = configValues.find(key);
+    if (it == configValues.end()) {
+        return defaultValue;
+    }
+    try {
+        unsigned long valColor = std::stoul(it->second, nullptr, 16);
+        SDL_Color color = defaultValue;
+        color.r = (valColor >> 16) & 0xff;
+        color.g = (valColor >> 8) & 0xff;
+        color.b = (valColor >> 0) & 0xff;
+        return color;
+    } catch (const std::exception& e) {
+        std::cerr << "Error converting value for key '" << key << "' to color: " << e.what() << std::endl;
+        return defaultValue;
+    }
 }
 
 void Theme::setValue(const std::string& key, const std::string& value) {
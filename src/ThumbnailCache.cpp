@@ -1,21 +1,73 @@
 #include "ThumbnailCache.h"
-#include <map>
 
-SDL_Surface* ThumbnailCache::get(const std::string& key) {
-    if (cache.find(key) != cache.end()) {
-        return cache[key];
+ThumbnailCache::ThumbnailCache(std::size_t budget) : budget(budget) {
+}
+
+ThumbnailCache::~ThumbnailCache() {
+    clear();
+}
+
+std::size_t ThumbnailCache::getSize(const std::string& path, const SDL_Surface* surface) {
+    // Entries without art still cost their key, so they can't pile up forever
+    std::size_t size = sizeof(Entry) + path.size();
+    if (surface) {
+        size += static_cast<std::size_t>(surface->pitch) * surface->h;
+    }
+    return size;
+}
+
+bool ThumbnailCache::get(const std::string& path, SDL_Surface*& surface) {
+    auto it = index.find(path);
+    if (it == index.end()) {
+        return false;
     }
-    return nullptr;
+
+    entries.splice(entries.begin(), entries, it->second);
+    surface = it->second->surface;
+    return true;
 }
 
-void ThumbnailCache::set(const std::string& key, SDL_Surface* surface) {
-    if (cache.size() >= MAX_SIZE) {
-        // Evict the first (or any other policy) item for simplicity
-        if (cache.begin()->second != surface) {
-            SDL_FreeSurface(cache.begin()->second);
-        }           
-        cache.erase(cache.begin());
+void ThumbnailCache::put(const std::string& path, SDL_Surface* surface) {
+    auto it = index.find(path);
+    if (it != index.end()) {
+        Entry& entry = *it->second;
+        if (entry.surface && entry.surface != surface) {
+            SDL_FreeSurface(entry.surface);
+        }
+        bytes -= entry.bytes;
+        entry.surface = surface;
+        entry.bytes = getSize(path, surface);
+        bytes += entry.bytes;
+        entries.splice(entries.begin(), entries, it->second);
+    } else {
+        entries.push_front({path, surface, getSize(path, surface)});
+        index.emplace(path, entries.begin());
+        bytes += entries.front().bytes;
     }
-    cache[key] = surface;
+
+    evict();
 }
 
+void ThumbnailCache::evict() {
+    // Least recently used go first, the newest entry always stays
+    while (bytes > budget && entries.size() > 1) {
+        Entry& entry = entries.back();
+        index.erase(entry.path);
+        bytes -= entry.bytes;
+        if (entry.surface) {
+            SDL_FreeSurface(entry.surface);
+        }
+        entries.pop_back();
+    }
+}
+
+void ThumbnailCache::clear() {
+    index.clear();
+    for (Entry& entry : entries) {
+        if (entry.surface) {
+            SDL_FreeSurface(entry.surface);
+        }
+    }
+    entries.clear();
+    bytes = 0;
+}
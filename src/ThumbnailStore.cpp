@@ -0,0 +1,239 @@
+#include "ThumbnailStore.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Headers are written and read as raw bytes, so they must keep this layout
+static_assert(sizeof(ThumbnailFileHeader) == 56, "unexpected ThumbnailFileHeader layout");
+
+const char ThumbnailStore::MAGIC[4] = {'S', 'M', 'P', 'T'};
+const std::uint32_t ThumbnailStore::VERSION = 1;
+
+namespace {
+
+bool readFully(int fd, void* buffer, std::size_t size) {
+    char* data = static_cast<char*>(buffer);
+    while (size > 0) {
+        ssize_t n = ::read(fd, data, size);
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+}
+
+ThumbnailStore::ThumbnailStore(const std::string& directory, const SDL_PixelFormat& format,
+                               std::uint64_t budget)
+    : directory(directory), format(format) {
+
+    // Palettes belong to the screen, only direct color formats are stored
+    this->format.palette = nullptr;
+    if (format.BitsPerPixel <= 8) {
+        this->directory.clear();
+    }
+
+    if (!this->directory.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(this->directory, ec);
+        if (ec) {
+            std::cerr << "Unable to create thumbnail cache " << this->directory << ": "
+                      << ec.message() << std::endl;
+            this->directory.clear();
+        }
+    }
+
+    if (!this->directory.empty()) {
+        prune(budget);
+    }
+}
+
+void ThumbnailStore::prune(std::uint64_t budget) const {
+    struct StoredFile {
+        std::filesystem::path path;
+        std::uint64_t size;
+        std::filesystem::file_time_type mtime;
+    };
+    std::vector<StoredFile> files;
+    std::uint64_t total = 0;
+
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code fileEc;
+        if (!it->is_regular_file(fileEc)) {
+            continue;
+        }
+        // Left by a save that never finished
+        if (it->path().extension() == ".tmp") {
+            std::filesystem::remove(it->path(), fileEc);
+            continue;
+        }
+        if (it->path().extension() != ".thumb") {
+            continue;
+        }
+        StoredFile file = {it->path(), it->file_size(fileEc), it->last_write_time(fileEc)};
+        if (!fileEc) {
+            total += file.size;
+            files.push_back(std::move(file));
+        }
+    }
+
+    if (total <= budget) {
+        return;
+    }
+
+    // Nothing records reads, the write time is the best age there is
+    std::sort(files.begin(), files.end(), [](const StoredFile& a, const StoredFile& b) {
+        return a.mtime < b.mtime;
+    });
+    std::size_t removed = 0;
+    for (const StoredFile& file : files) {
+        if (total <= budget) {
+            break;
+        }
+        std::error_code fileEc;
+        if (std::filesystem::remove(file.path, fileEc)) {
+            total -= file.size;
+            removed++;
+        }
+    }
+    std::cout << "Pruned " << removed << " thumbnails from " << directory << std::endl;
+}
+
+std::string ThumbnailStore::getFilePath(const std::string& path, int boxWidth, int boxHeight) const {
+    // FNV-1a of the source path and the art box. The path is stored in the
+    // file as well, so a collision reads as a miss
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](unsigned char c) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    };
+    for (char c : path) {
+        mix(c);
+    }
+    mix(0);
+    for (int value : {boxWidth, boxHeight}) {
+        for (int i = 0; i < 4; i++) {
+            mix((value >> (i * 8)) & 0xff);
+        }
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.thumb", static_cast<unsigned long long>(hash));
+    return directory + "/" + name;
+}
+
+SDL_Surface* ThumbnailStore::load(const std::string& path, std::time_t mtime,
+                                  int boxWidth, int boxHeight) const {
+    if (!isEnabled()) {
+        return nullptr;
+    }
+
+    int fd = ::open(getFilePath(path, boxWidth, boxHeight).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    ThumbnailFileHeader h;
+    std::string storedPath;
+    bool valid = readFully(fd, &h, sizeof(h))
+        && std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) == 0
+        && h.version == VERSION
+        && h.mtime == static_cast<std::int64_t>(mtime)
+        && h.boxWidth == boxWidth && h.boxHeight == boxHeight
+        && h.bitsPerPixel == format.BitsPerPixel
+        && h.rmask == format.Rmask && h.gmask == format.Gmask
+        && h.bmask == format.Bmask && h.amask == format.Amask
+        && h.pathSize == path.size();
+
+    if (valid) {
+        storedPath.resize(h.pathSize);
+        valid = readFully(fd, &storedPath[0], h.pathSize) && storedPath == path;
+    }
+
+    SDL_Surface* surface = nullptr;
+    if (valid) {
+        surface = SDL_CreateRGBSurface(SDL_SWSURFACE, h.width, h.height, h.bitsPerPixel,
+                                       h.rmask, h.gmask, h.bmask, h.amask);
+    }
+
+    if (surface) {
+        // Rows go straight into the surface, in one read when pitches match
+        bool ok = true;
+        SDL_LockSurface(surface);
+        char* pixels = static_cast<char*>(surface->pixels);
+        if (surface->pitch == h.pitch) {
+            ok = readFully(fd, pixels, static_cast<std::size_t>(h.pitch) * h.height);
+        } else if (surface->pitch > h.pitch) {
+            for (int y = 0; ok && y < h.height; y++) {
+                ok = readFully(fd, pixels + y * surface->pitch, h.pitch);
+            }
+        } else {
+            ok = false;
+        }
+        SDL_UnlockSurface(surface);
+
+        if (!ok) {
+            SDL_FreeSurface(surface);
+            surface = nullptr;
+        }
+    }
+
+    ::close(fd);
+    return surface;
+}
+
+bool ThumbnailStore::save(const std::string& path, std::time_t mtime, int boxWidth, int boxHeight,
+                          SDL_Surface* surface) const {
+    if (!isEnabled() || !surface || surface->format->BitsPerPixel != format.BitsPerPixel) {
+        return false;
+    }
+
+    ThumbnailFileHeader h;
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.mtime = mtime;
+    h.boxWidth = boxWidth;
+    h.boxHeight = boxHeight;
+    h.width = surface->w;
+    h.height = surface->h;
+    h.pitch = surface->pitch;
+    h.bitsPerPixel = format.BitsPerPixel;
+    h.rmask = format.Rmask;
+    h.gmask = format.Gmask;
+    h.bmask = format.Bmask;
+    h.amask = format.Amask;
+    h.pathSize = path.size();
+    h.reserved = 0;
+
+    // Written under a temporary name, a crash never leaves a torn file behind
+    std::string filePath = getFilePath(path, boxWidth, boxHeight);
+    std::string tmpPath = filePath + ".tmp";
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        return false;
+    }
+
+    std::size_t pixelsSize = static_cast<std::size_t>(surface->pitch) * surface->h;
+    SDL_LockSurface(surface);
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1
+        && fwrite(path.data(), 1, path.size(), fp) == path.size()
+        && fwrite(surface->pixels, 1, pixelsSize, fp) == pixelsSize;
+    SDL_UnlockSurface(surface);
+    ok = fclose(fp) == 0 && ok;
+
+    if (!ok || rename(tmpPath.c_str(), filePath.c_str()) != 0) {
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}